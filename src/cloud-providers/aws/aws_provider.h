@@ -22,6 +22,9 @@ class StartStreamTranscriptionHandler;
 
 class AWSProvider : public CloudProvider {
 public:
+	static constexpr ProviderCapabilities capabilities = {
+		"aws", 8000, 48000, AUDIO_ENCODING_PCM_S16LE, true, 0, 100, 200};
+
 	AWSProvider(TranscriptionCallback callback, cloudvocal_data *gf)
 		: CloudProvider(callback, gf)
 	{
@@ -46,7 +49,7 @@ private:
 	std::shared_ptr<Aws::TranscribeStreamingService::Model::StartStreamTranscriptionHandler>
 		handler;
 
-	std::queue<std::vector<float>> audio_buffer_queue;
+	std::queue<std::vector<uint8_t>> audio_buffer_queue;
 	std::mutex audio_buffer_queue_mutex;
 	std::condition_variable audio_buffer_queue_cv;
 	std::atomic<bool> stream_open = false;
@@ -19,8 +19,6 @@ using namespace Aws;
 using namespace Aws::TranscribeStreamingService;
 using namespace Aws::TranscribeStreamingService::Model;
 
-static const int SAMPLE_RATE = 16000; // for the file above
-
 bool AWSProvider::init()
 {
 	if (this->stop_requested) {
@@ -78,7 +76,7 @@ bool AWSProvider::init()
 	});
 
 	this->request.reset(new StartStreamTranscriptionRequest());
-	this->request->SetMediaSampleRateHertz(SAMPLE_RATE);
+	this->request->SetMediaSampleRateHertz(session.sample_rate);
 	this->request->SetLanguageCode(Aws::TranscribeStreamingService::Model::LanguageCode::en_US);
 	// Aws::TranscribeStreamingService::Model::LanguageCodeMapper::GetLanguageCodeForName(
 	// 	gf->language));
@@ -114,19 +112,10 @@ bool AWSProvider::init()
 				continue;
 			}
 			// get the audio buffer
-			std::vector<float> audio_buffer = this->audio_buffer_queue.front();
+			std::vector<uint8_t> audio_chunk = std::move(this->audio_buffer_queue.front());
 			this->audio_buffer_queue.pop();
 			lock.unlock();
 
-			// convert the audio buffer to a byte array
-			std::vector<uint8_t> audio_chunk;
-			audio_chunk.reserve(audio_buffer.size() * sizeof(int16_t));
-			for (auto sample : audio_buffer) {
-				int16_t sample_int = static_cast<int16_t>(sample * 32767);
-				audio_chunk.push_back(sample_int & 0xFF);
-				audio_chunk.push_back((sample_int >> 8) & 0xFF);
-			}
-
 			// write the audio chunk to the stream
 			Aws::Vector<unsigned char> bits{audio_chunk.begin(), audio_chunk.end()};
 			AudioEvent event(std::move(bits));
@@ -170,9 +159,11 @@ void AWSProvider::sendAudioBufferToTranscription(const std::deque<float> &audio_
 	if (this->stop_requested || !this->stream_open) {
 		return;
 	}
-	// queue up the audio buffer
+	// encode on this thread and queue up the bytes for the stream thread
+	std::vector<uint8_t> audio_chunk;
+	encode_audio_samples(audio_buffer, session.encoding, audio_chunk);
 	std::lock_guard<std::mutex> lock(audio_buffer_queue_mutex);
-	audio_buffer_queue.push(std::vector<float>(audio_buffer.begin(), audio_buffer.end()));
+	audio_buffer_queue.push(std::move(audio_chunk));
 	audio_buffer_queue_cv.notify_one();
 }
 
@@ -1,28 +1,83 @@
 #include "cloud-provider.h"
 #include "cloudvocal-callbacks.h"
+#include "cloudvocal-utils.h"
 #include "clova/clova-provider.h"
 #include "google/google-provider.h"
 #include "aws/aws_provider.h"
 #include "revai/revai-provider.h"
 #include "deepgram/deepgram-provider.h"
 
+// Providers that can be selected in the settings. Each type provides a static constexpr
+// `capabilities` member and a (callback, gf) constructor.
+template<typename... Providers> struct ProviderRegistry {
+	static const ProviderCapabilities *capabilities(const std::string &id)
+	{
+		const ProviderCapabilities *found = nullptr;
+		((id == Providers::capabilities.id ? (found = &Providers::capabilities, true)
+						   : false) ||
+		 ...);
+		return found;
+	}
+
+	static std::shared_ptr<CloudProvider> create(const std::string &id,
+						     CloudProvider::TranscriptionCallback callback,
+						     cloudvocal_data *gf)
+	{
+		std::shared_ptr<CloudProvider> provider;
+		((id == Providers::capabilities.id
+			  ? (provider = std::make_shared<Providers>(callback, gf), true)
+			  : false) ||
+		 ...);
+		return provider;
+	}
+};
+
+using CloudProviders = ProviderRegistry<ClovaProvider, GoogleProvider, AWSProvider, RevAIProvider,
+					DeepgramProvider>;
+
+const ProviderCapabilities *getProviderCapabilities(const std::string &providerType)
+{
+	return CloudProviders::capabilities(providerType);
+}
+
 std::shared_ptr<CloudProvider> createCloudProvider(const std::string &providerType,
 						   CloudProvider::TranscriptionCallback callback,
 						   cloudvocal_data *gf)
 {
-	if (providerType == "clova") {
-		return std::make_shared<ClovaProvider>(callback, gf);
-	} else if (providerType == "google") {
-		return std::make_unique<GoogleProvider>(callback, gf);
-	} else if (providerType == "aws") {
-		return std::make_unique<AWSProvider>(callback, gf);
-	} else if (providerType == "revai") {
-		return std::make_unique<RevAIProvider>(callback, gf);
-	} else if (providerType == "deepgram") {
-		return std::make_unique<DeepgramProvider>(callback, gf);
-	}
-
-	return nullptr; // Return nullptr if no matching provider is found
+	// Return nullptr if no matching provider is found
+	return CloudProviders::create(providerType, callback, gf);
+}
+
+AudioSessionConfig selectAudioSession(const ProviderCapabilities &caps, const cloudvocal_data *gf)
+{
+	const uint32_t input_rate = (uint32_t)gf->sample_rate;
+	uint32_t rate = TRANSCRIPTION_SAMPLE_RATE;
+	if (gf->audio_bandwidth_mode == AUDIO_BANDWIDTH_TELEPHONY) {
+		rate = 8000;
+	} else if (gf->audio_bandwidth_mode == AUDIO_BANDWIDTH_NATIVE &&
+		   input_rate >= caps.min_sample_rate && input_rate <= caps.max_sample_rate) {
+		// sending the mix rate as-is skips the resampler entirely
+		rate = input_rate;
+	}
+
+	AudioSessionConfig session = {};
+	session.sample_rate = std::clamp(rate, caps.min_sample_rate, caps.max_sample_rate);
+	// 16-bit PCM unless the audio is telephony band anyway, where mu-law halves the bytes
+	// sent without losing anything the recognizer uses
+	session.encoding = AUDIO_ENCODING_PCM_S16LE;
+	if (session.sample_rate <= 8000 && (caps.encodings & AUDIO_ENCODING_MULAW) != 0) {
+		session.encoding = AUDIO_ENCODING_MULAW;
+	}
+	session.frame_samples =
+		std::max<size_t>(1, (size_t)session.sample_rate * caps.frame_ms / 1000);
+	session.max_chunk_samples =
+		std::max<size_t>(1, (size_t)session.sample_rate * caps.max_chunk_ms / 1000 /
+					    session.frame_samples) *
+		session.frame_samples;
+	session.resample = input_rate != session.sample_rate;
+	session.partial_results = caps.partial_results && gf->partial_transcription;
+	session.keepalive_interval_ms = caps.keepalive_interval_ms;
+	return session;
 }
 
 void restart_cloud_provider(cloudvocal_data *gf)
@@ -32,6 +87,43 @@ void restart_cloud_provider(cloudvocal_data *gf)
 		gf->cloud_provider->stop();
 		gf->cloud_provider = nullptr;
 	}
+	const ProviderCapabilities *caps = getProviderCapabilities(gf->cloud_provider_selection);
+	if (caps == nullptr) {
+		obs_log(LOG_ERROR, "Unknown cloud provider '%s'",
+			gf->cloud_provider_selection.c_str());
+		gf->active = false;
+		return;
+	}
+	gf->audio_session = selectAudioSession(*caps, gf);
+	obs_log(gf->log_level,
+		"Cloud provider '%s' session: %u Hz, encoding %u, %zu samples per frame, "
+		"resample %d, partials %d, keepalive %u ms",
+		caps->id, gf->audio_session.sample_rate, (uint32_t)gf->audio_session.encoding,
+		gf->audio_session.frame_samples, gf->audio_session.resample,
+		gf->audio_session.partial_results, gf->audio_session.keepalive_interval_ms);
+
+	// the resampler converts to the session rate, so it is rebuilt for every session
+	if (gf->resampler) {
+		audio_resampler_destroy(gf->resampler);
+		gf->resampler = nullptr;
+	}
+	if (gf->audio_session.resample) {
+		struct resample_info src, dst;
+		src.samples_per_sec = gf->sample_rate;
+		src.format = AUDIO_FORMAT_FLOAT_PLANAR;
+		src.speakers = convert_speaker_layout((uint8_t)gf->channels);
+
+		dst.samples_per_sec = gf->audio_session.sample_rate;
+		dst.format = AUDIO_FORMAT_FLOAT_PLANAR;
+		dst.speakers = convert_speaker_layout((uint8_t)1);
+
+		gf->resampler = audio_resampler_create(&dst, &src);
+		if (!gf->resampler) {
+			obs_log(LOG_ERROR, "Failed to create resampler");
+			gf->active = false;
+			return;
+		}
+	}
 	gf->cloud_provider = createCloudProvider(
 		gf->cloud_provider_selection,
 		[gf](const DetectionResultWithText &result) {
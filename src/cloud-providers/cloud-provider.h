@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
 #include <functional>
 #include <thread>
 #include <atomic>
@@ -8,8 +10,22 @@
 
 #include "cloudvocal-processing.h"
 #include "cloudvocal-data.h"
+#include "language-codes/language-codes.h"
 #include "plugin-support.h"
 
+// What a provider's streaming API accepts. Each provider declares these as a static constexpr
+// `capabilities` member so the audio pipeline can be configured before the session starts.
+struct ProviderCapabilities {
+	const char *id;                 // value of the transcription_cloud_provider setting
+	uint32_t min_sample_rate;       // accepted sample rate range in Hz
+	uint32_t max_sample_rate;
+	uint32_t encodings;             // AudioEncoding flags
+	bool partial_results;           // can stream interim results
+	uint32_t keepalive_interval_ms; // keepalive period while no audio is sent, 0 if not needed
+	uint32_t frame_ms;              // preferred audio chunk duration
+	uint32_t max_chunk_ms;          // longest chunk accepted in a single message
+};
+
 class CloudProvider {
 public:
 	using TranscriptionCallback = std::function<void(const DetectionResultWithText &)>;
@@ -19,7 +35,10 @@ public:
 		  running(false),
 		  gf(gf_),
 		  stop_requested(false),
-		  needs_results_thread(false)
+		  needs_results_thread(false),
+		  session(gf_->audio_session),
+		  language_code(language_code_from_underscore(gf_->language)),
+		  language_locale(getLanguageLocale(gf_->language))
 	{
 	}
 
@@ -58,6 +77,8 @@ protected:
 	virtual void sendAudioBufferToTranscription(const std::deque<float> &audio_buffer) = 0;
 	virtual void readResultsFromTranscription() = 0;
 	virtual void shutdown() = 0;
+	// called when no audio was sent for session.keepalive_interval_ms
+	virtual void sendKeepAlive() {}
 
 	void processAudio()
 	{
@@ -72,27 +93,51 @@ protected:
 
 		uint64_t start_timestamp_offset_ns = 0;
 		uint64_t end_timestamp_offset_ns = 0;
+		const std::chrono::milliseconds keepalive_interval(session.keepalive_interval_ms);
+		auto last_send_time = std::chrono::steady_clock::now();
+		std::deque<float> chunk;
+		gf->resampled_buffer.clear();
 
 		while (running && !stop_requested) {
 			get_data_from_buf_and_resample(gf, start_timestamp_offset_ns,
 						       end_timestamp_offset_ns);
 
-			if (gf->resampled_buffer.empty()) {
-				std::this_thread::sleep_for(std::chrono::milliseconds(10));
-				continue;
+			// send whole frames of the size the provider prefers, and catch up on a
+			// backlog with fewer, larger chunks
+			while (gf->resampled_buffer.size() >= session.frame_samples &&
+			       !stop_requested) {
+				const size_t chunk_samples = std::min(
+					gf->resampled_buffer.size() / session.frame_samples *
+						session.frame_samples,
+					session.max_chunk_samples);
+				chunk.assign(gf->resampled_buffer.begin(),
+					     gf->resampled_buffer.begin() + chunk_samples);
+				gf->resampled_buffer.erase(gf->resampled_buffer.begin(),
+							   gf->resampled_buffer.begin() +
+								   chunk_samples);
+				sendAudioBufferToTranscription(chunk);
+				last_send_time = std::chrono::steady_clock::now();
 			}
 
-			sendAudioBufferToTranscription(gf->resampled_buffer);
-
-			gf->resampled_buffer.clear();
+			const auto idle = std::chrono::steady_clock::now() - last_send_time;
+			if (session.keepalive_interval_ms > 0 && idle >= keepalive_interval) {
+				sendKeepAlive();
+				last_send_time = std::chrono::steady_clock::now();
+			}
 
 			// sleep until the next audio packet is ready
 			// wait for notificaiton from the audio buffer condition variable
 			std::unique_lock<std::mutex> lock(gf->input_buffers_mutex);
-			gf->input_buffers_cv.wait(lock, [this] {
+			auto has_input = [this] {
 				return !(gf->input_buffers[0]).empty() || !running ||
 				       stop_requested;
-			});
+			};
+			if (session.keepalive_interval_ms > 0) {
+				// wake up in time to keep the connection alive while muted
+				gf->input_buffers_cv.wait_for(lock, keepalive_interval, has_input);
+			} else {
+				gf->input_buffers_cv.wait(lock, has_input);
+			}
 		}
 
 		// Shutdown the cloud provider
@@ -116,12 +161,23 @@ protected:
 	std::atomic<bool> stop_requested;
 	TranscriptionCallback transcription_callback;
 	bool needs_results_thread;
+	// audio format and stages selected from the provider's capabilities
+	const AudioSessionConfig session;
+	// session language, resolved once when the provider is created
+	const std::string language_code;   // e.g. "en"
+	const std::string language_locale; // e.g. "en-US"
 
 private:
 	std::thread transcription_thread;
 	std::thread results_thread;
 };
 
+// Returns nullptr for an unknown provider id
+const ProviderCapabilities *getProviderCapabilities(const std::string &providerType);
+
+// Picks the sample rate, encoding, frame size and optional stages for a provider session
+AudioSessionConfig selectAudioSession(const ProviderCapabilities &caps, const cloudvocal_data *gf);
+
 std::shared_ptr<CloudProvider> createCloudProvider(const std::string &providerType,
 						   CloudProvider::TranscriptionCallback callback,
 						   cloudvocal_data *gf);
@@ -10,7 +10,6 @@
 #include "nlohmann/json.hpp"
 
 #include "cloud-providers/clova/nest.grpc.pb.h"
-#include "language-codes/language-codes.h"
 #include "utils/ssl-utils.h"
 
 using grpc::Status;
@@ -53,7 +52,7 @@ bool ClovaProvider::init()
 	}
 
 	json config_payload = {
-		{"transcription", {{"language", language_codes_from_underscore[gf->language]}}},
+		{"transcription", {{"language", language_code}}},
 	};
 
 	// Send the config request to Clova
@@ -93,14 +92,10 @@ void ClovaProvider::sendAudioBufferToTranscription(const std::deque<float> &audi
 	NestRequest data_request;
 	data_request.set_type(RequestType::DATA);
 
-	// convert from float [-1,1] to int16
-	std::vector<int16_t> audio_buffer_int16(audio_buffer.size());
-	std::transform(audio_buffer.begin(), audio_buffer.end(), audio_buffer_int16.begin(),
-		       [](float f) { return static_cast<int16_t>(f * 32767); });
+	std::vector<uint8_t> audio_bytes;
+	encode_audio_samples(audio_buffer, session.encoding, audio_bytes);
 
-	data_request.mutable_data()->set_chunk(
-		reinterpret_cast<uint8_t *>(audio_buffer_int16.data()),
-		audio_buffer_int16.size() * sizeof(int16_t));
+	data_request.mutable_data()->set_chunk(audio_bytes.data(), audio_bytes.size());
 	data_request.mutable_data()->set_extra_contents("{\"seqId\": " + std::to_string(chunk_id) +
 							", \"epFlag\": false}");
 
@@ -145,7 +140,7 @@ void ClovaProvider::readResultsFromTranscription()
 				DetectionResultWithText result;
 				result.text = this->current_sentence;
 				result.result = DETECTION_RESULT_SPEECH;
-				result.language = language_codes_from_underscore[gf->language];
+				result.language = language_code;
 				this->transcription_callback(result);
 				this->current_sentence.clear();
 			} else {
@@ -154,8 +149,7 @@ void ClovaProvider::readResultsFromTranscription()
 					DetectionResultWithText result;
 					result.text = this->current_sentence;
 					result.result = DETECTION_RESULT_PARTIAL;
-					result.language =
-						language_codes_from_underscore[gf->language];
+					result.language = language_code;
 					this->transcription_callback(result);
 				}
 			}
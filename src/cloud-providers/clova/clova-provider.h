@@ -23,6 +23,10 @@ typedef grpc::ClientReaderWriter<NestRequest, NestResponse> ClovaReaderWriter;
 
 class ClovaProvider : public CloudProvider {
 public:
+	// the Nest API only takes 16 kHz 16-bit PCM
+	static constexpr ProviderCapabilities capabilities = {
+		"clova", 16000, 16000, AUDIO_ENCODING_PCM_S16LE, true, 0, 100, 1000};
+
 	ClovaProvider(TranscriptionCallback callback, cloudvocal_data *gf_)
 		: CloudProvider(callback, gf_),
 		  chunk_id(1),
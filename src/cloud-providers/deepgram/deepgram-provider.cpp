@@ -1,8 +1,6 @@
 #include "deepgram-provider.h"
 #include <nlohmann/json.hpp>
 
-#include "language-codes/language-codes.h"
-
 using json = nlohmann::json;
 
 namespace http = beast::http;
@@ -49,8 +47,13 @@ bool DeepgramProvider::init()
 					"token, " + std::string(gf->cloud_provider_api_key));
 			}));
 
-		std::string query = std::string("/v1/listen?encoding=linear16&sample_rate=16000") +
-				    "&language=" + language_codes_from_underscore[gf->language];
+		std::string query = std::string("/v1/listen?encoding=") +
+				    (session.encoding == AUDIO_ENCODING_MULAW ? "mulaw" : "linear16") +
+				    "&sample_rate=" + std::to_string(session.sample_rate) +
+				    "&language=" + language_code;
+		if (session.partial_results) {
+			query += "&interim_results=true";
+		}
 		// Perform WebSocket handshake
 		ws.handshake("api.deepgram.com", query);
 
@@ -68,18 +71,11 @@ void DeepgramProvider::sendAudioBufferToTranscription(const std::deque<float> &a
 		return;
 
 	try {
-		// Convert float audio to int16_t (linear16 format)
-		std::vector<int16_t> pcm_data;
-		pcm_data.reserve(audio_buffer.size());
-
-		for (float sample : audio_buffer) {
-			// Clamp and convert to int16
-			float clamped = std::max(-1.0f, std::min(1.0f, sample));
-			pcm_data.push_back(static_cast<int16_t>(clamped * 32767.0f));
-		}
+		encode_audio_samples(audio_buffer, session.encoding, audio_bytes);
 
 		// Send binary message
-		ws.write(net::buffer(pcm_data.data(), pcm_data.size() * sizeof(int16_t)));
+		ws.binary(true);
+		ws.write(net::buffer(audio_bytes));
 
 	} catch (std::exception const &e) {
 		obs_log(LOG_ERROR, "Error sending audio to Deepgram: %s", e.what());
@@ -122,11 +118,23 @@ void DeepgramProvider::readResultsFromTranscription()
 	}
 }
 
+void DeepgramProvider::sendKeepAlive()
+{
+	try {
+		ws.text(true);
+		ws.write(net::buffer(std::string(R"({"type":"KeepAlive"})")));
+	} catch (std::exception const &e) {
+		obs_log(LOG_ERROR, "Error sending keepalive to Deepgram: %s", e.what());
+		running = false;
+	}
+}
+
 void DeepgramProvider::shutdown()
 {
 	try {
 		// Send close message
-		ws.write(net::buffer(R"({"type":"CloseStream"})"));
+		ws.text(true);
+		ws.write(net::buffer(std::string(R"({"type":"CloseStream"})")));
 
 		// Close WebSocket connection
 		ws.close(websocket::close_code::normal);
@@ -15,6 +15,11 @@ using tcp = boost::asio::ip::tcp;
 
 class DeepgramProvider : public CloudProvider {
 public:
+	// Deepgram closes the socket after 10 s without audio unless it gets a KeepAlive
+	static constexpr ProviderCapabilities capabilities = {
+		"deepgram", 8000, 48000, AUDIO_ENCODING_PCM_S16LE | AUDIO_ENCODING_MULAW, true,
+		5000, 50, 1000};
+
 	DeepgramProvider(TranscriptionCallback callback, cloudvocal_data *gf_);
 	bool init() override;
 
@@ -22,10 +27,12 @@ protected:
 	void sendAudioBufferToTranscription(const std::deque<float> &audio_buffer) override;
 	void readResultsFromTranscription() override;
 	void shutdown() override;
+	void sendKeepAlive() override;
 
 private:
 	net::io_context ioc;
 	ssl::context ssl_ctx;
 	tcp::resolver resolver;
 	websocket::stream<beast::ssl_stream<tcp::socket>> ws;
+	std::vector<uint8_t> audio_bytes;
 };
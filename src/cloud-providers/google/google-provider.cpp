@@ -1,12 +1,32 @@
 #include "google-provider.h"
-#include "language-codes/language-codes.h"
 #include "utils/ssl-utils.h"
 
+#include <algorithm>
+#include <cctype>
+
 using namespace google::cloud::speech::v1;
 
+// Google ends a StreamingRecognize call after roughly five minutes of streaming. Open the next
+// stream ahead of that limit and feed both for a short overlap so no audio falls in between.
+static const std::chrono::seconds STREAM_ROTATION_INTERVAL(285);
+static const uint64_t STREAM_OVERLAP_MS = 5000;
+// How long committed text is kept to cut it from the interim results of the next stream. Well
+// beyond the overlap, the draining stream may still finalize a long phrase after it.
+static const uint64_t COMMITTED_TEXT_KEEP_MS = 30000;
+
+static uint64_t durationToMs(const google::protobuf::Duration &duration)
+{
+	return (uint64_t)duration.seconds() * 1000 + (uint64_t)duration.nanos() / 1000000;
+}
+
 bool GoogleProvider::init()
 {
 	initialized = false;
+	samples_sent = 0;
+	committed_end_ms = 0;
+	committed_text.clear();
+	committed_words.clear();
+	last_partial_transcript.clear();
 
 	grpc::SslCredentialsOptions ssl_opts;
 	ssl_opts.pem_root_certs = PEMrootCerts();
@@ -14,38 +34,116 @@ bool GoogleProvider::init()
 	this->channel =
 		grpc::CreateChannel("speech.googleapis.com", grpc::SslCredentials(ssl_opts));
 	this->stub = Speech::NewStub(channel);
-	this->context.AddMetadata("x-goog-api-key", gf->cloud_provider_api_key);
-	this->reader_writer = this->stub->StreamingRecognize(&context);
-	if (!reader_writer) {
-		obs_log(LOG_ERROR, "Failed to create reader writer for Google");
+
+	std::shared_ptr<RecognizeStream> stream = openStream();
+	if (!stream) {
 		return false;
 	}
+	{
+		std::lock_guard<std::mutex> lock(streams_mutex);
+		streams.push_back(stream);
+	}
+
+	initialized = true;
+	return initialized;
+}
+
+std::shared_ptr<GoogleProvider::RecognizeStream> GoogleProvider::openStream()
+{
+	auto stream = std::make_shared<RecognizeStream>();
+	stream->start_sample = samples_sent;
+	stream->opened_at = std::chrono::steady_clock::now();
+	stream->context.AddMetadata("x-goog-api-key", gf->cloud_provider_api_key);
+	stream->reader_writer = this->stub->StreamingRecognize(&stream->context);
+	if (!stream->reader_writer) {
+		obs_log(LOG_ERROR, "Failed to create reader writer for Google");
+		return nullptr;
+	}
 
 	// Send the config request
-	obs_log(gf->log_level, "Sending config request to Google");
+	obs_log(gf->log_level, "Sending config request to Google (stream offset %llu ms)",
+		samplesToMs(stream->start_sample));
 	StreamingRecognizeRequest config_request;
 	StreamingRecognitionConfig *streaming_config = config_request.mutable_streaming_config();
 	RecognitionConfig *config = streaming_config->mutable_config();
-	config->set_language_code(getLanguageLocale(gf->language));
-	config->set_sample_rate_hertz(16000);
+	config->set_language_code(language_locale);
+	config->set_sample_rate_hertz(session.sample_rate);
 	config->set_audio_channel_count(1);
-	config->set_encoding(RecognitionConfig_AudioEncoding_LINEAR16);
+	config->set_encoding(session.encoding == AUDIO_ENCODING_MULAW
+				     ? RecognitionConfig_AudioEncoding_MULAW
+				     : RecognitionConfig_AudioEncoding_LINEAR16);
+	// word offsets are needed to stitch results across overlapping streams
+	config->set_enable_word_time_offsets(true);
 	streaming_config->set_single_utterance(false);
-	streaming_config->set_interim_results(true);
-	if (!reader_writer->Write(config_request)) {
+	streaming_config->set_interim_results(session.partial_results);
+	if (!stream->reader_writer->Write(config_request)) {
 		obs_log(LOG_ERROR, "Failed to send config request to Google");
-		return false;
+		return nullptr;
 	}
 	obs_log(gf->log_level, "Config request sent to Google");
 
-	initialized = true;
-	return initialized;
+	return stream;
+}
+
+void GoogleProvider::rotateStreams()
+{
+	// opening a stream and WritesDone block on the network, they run outside the lock so
+	// the results thread and shutdown are not held up by a stalled stream
+	bool needs_new_stream;
+	{
+		std::lock_guard<std::mutex> lock(streams_mutex);
+		needs_new_stream = streams.empty() || streams.back()->failed ||
+				   std::chrono::steady_clock::now() - streams.back()->opened_at >=
+					   STREAM_ROTATION_INTERVAL;
+	}
+	if (needs_new_stream) {
+		obs_log(gf->log_level, "Rotating Google stream at %llu ms",
+			samplesToMs(samples_sent));
+		std::shared_ptr<RecognizeStream> stream = openStream();
+		if (!stream) {
+			this->stop_requested = true;
+			return;
+		}
+		std::lock_guard<std::mutex> lock(streams_mutex);
+		streams.push_back(stream);
+	}
+
+	// close the older streams once the active one has received the overlap
+	std::vector<std::shared_ptr<RecognizeStream>> closing;
+	{
+		std::lock_guard<std::mutex> lock(streams_mutex);
+		// the results thread may have dropped a stream that ended meanwhile
+		if (streams.empty()) {
+			return;
+		}
+		const std::shared_ptr<RecognizeStream> &active = streams.back();
+		if (samplesToMs(samples_sent - active->start_sample) < STREAM_OVERLAP_MS) {
+			return;
+		}
+		for (const auto &stream : streams) {
+			if (stream != active && !stream->writes_done) {
+				// claimed here, so shutdown does not close it too
+				stream->writes_done = true;
+				closing.push_back(stream);
+			}
+		}
+	}
+	for (const auto &stream : closing) {
+		obs_log(gf->log_level, "Closing Google stream opened at %llu ms",
+			samplesToMs(stream->start_sample));
+		stream->reader_writer->WritesDone();
+	}
+}
+
+uint64_t GoogleProvider::samplesToMs(uint64_t samples) const
+{
+	return samples * 1000 / session.sample_rate;
 }
 
 void GoogleProvider::sendAudioBufferToTranscription(const std::deque<float> &audio_buffer)
 {
-	if (!reader_writer) {
-		obs_log(LOG_ERROR, "Reader writer is not initialized");
+	if (!initialized) {
+		obs_log(LOG_ERROR, "Google provider is not initialized");
 		return;
 	}
 	if (audio_buffer.empty()) {
@@ -53,27 +151,41 @@ void GoogleProvider::sendAudioBufferToTranscription(const std::deque<float> &aud
 		return;
 	}
 
-	// Send the audio buffer to Clova for transcription
+	rotateStreams();
+
+	// Send the audio buffer to Google for transcription
 	obs_log(gf->log_level,
 		"Sending audio buffer (%d) to Google for transcription. Chunk ID %llu",
 		audio_buffer.size(), chunk_id);
 
-	// convert from float [-1,1] to int16
-	std::vector<int16_t> audio_buffer_int16(audio_buffer.size());
-	std::transform(audio_buffer.begin(), audio_buffer.end(), audio_buffer_int16.begin(),
-		       [](float f) { return static_cast<int16_t>(f * 32767); });
+	std::vector<uint8_t> audio_bytes;
+	encode_audio_samples(audio_buffer, session.encoding, audio_bytes);
 
 	StreamingRecognizeRequest request;
-	request.set_audio_content(reinterpret_cast<const char *>(audio_buffer_int16.data()),
-				  audio_buffer_int16.size() * sizeof(int16_t));
+	request.set_audio_content(reinterpret_cast<const char *>(audio_bytes.data()),
+				  audio_bytes.size());
+
+	// during an overlap the same audio goes to the draining stream and the new one
+	std::vector<std::shared_ptr<RecognizeStream>> targets;
+	{
+		std::lock_guard<std::mutex> lock(streams_mutex);
+		for (const auto &stream : streams) {
+			if (!stream->writes_done && !stream->failed) {
+				targets.push_back(stream);
+			}
+		}
+	}
 
 	try {
-		bool success = reader_writer->Write(request);
-		if (!success) {
-			obs_log(LOG_ERROR, "Failed to send data request to Google");
-			this->stop_requested = true;
-			return;
+		for (const auto &stream : targets) {
+			if (!stream->reader_writer->Write(request)) {
+				obs_log(LOG_ERROR,
+					"Failed to send data request to Google stream at %llu ms",
+					samplesToMs(stream->start_sample));
+				stream->failed = true;
+			}
 		}
+		samples_sent += audio_buffer.size();
 		chunk_id++;
 	} catch (...) {
 		obs_log(LOG_ERROR, "Exception caught while sending data request to Google");
@@ -82,55 +194,304 @@ void GoogleProvider::sendAudioBufferToTranscription(const std::deque<float> &aud
 
 void GoogleProvider::readResultsFromTranscription()
 {
-	if (!reader_writer || !initialized) {
+	if (!initialized) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
 		return;
 	}
+
+	// results are read from the oldest stream until it ends, so everything a draining
+	// stream finalizes is committed before the next stream's results are considered
+	std::shared_ptr<RecognizeStream> stream;
+	{
+		std::lock_guard<std::mutex> lock(streams_mutex);
+		if (!streams.empty()) {
+			stream = streams.front();
+		}
+	}
+	if (!stream) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		return;
+	}
+
 	StreamingRecognizeResponse response;
-	if (reader_writer->Read(&response)) {
+	if (stream->reader_writer->Read(&response)) {
 		if (response.has_error()) {
 			obs_log(LOG_ERROR, "Google response Error: %s",
 				response.error().message().c_str());
 			return;
 		}
+		handleResponse(*stream, response);
+		return;
+	}
+
+	// the stream has ended, either after WritesDone or because the server closed it
+	grpc::Status status = stream->reader_writer->Finish();
+	if (!status.ok()) {
+		obs_log(LOG_ERROR, "Google stream ended with error: %s",
+			status.error_message().c_str());
+		if (status.error_code() == grpc::StatusCode::UNAUTHENTICATED ||
+		    status.error_code() == grpc::StatusCode::PERMISSION_DENIED ||
+		    status.error_code() == grpc::StatusCode::INVALID_ARGUMENT) {
+			// retrying with the same settings will not help
+			this->stop_requested = true;
+		}
+	}
+	std::lock_guard<std::mutex> lock(streams_mutex);
+	stream->failed = true;
+	if (!streams.empty() && streams.front() == stream) {
+		streams.pop_front();
+	}
+}
 
-		std::string overall_transcript;
-		bool is_final = false;
+// Offset of each word of the alternative in its transcript, looked up after the previous word.
+// Empty if a word is not found as it is spelled in the transcript.
+static std::vector<size_t> word_offsets(const SpeechRecognitionAlternative &alternative)
+{
+	const std::string &transcript = alternative.transcript();
+	std::vector<size_t> offsets;
+	size_t position = 0;
+	for (int w = 0; w < alternative.words_size(); w++) {
+		const std::string &word = alternative.words(w).word();
+		const size_t found = transcript.find(word, position);
+		if (word.empty() || found == std::string::npos) {
+			return {};
+		}
+		offsets.push_back(found);
+		position = found + word.size();
+	}
+	return offsets;
+}
 
-		for (int i = 0; i < response.results_size(); i++) {
-			const StreamingRecognitionResult &result = response.results(i);
-			obs_log(gf->log_level,
-				"Google Result %d. stability %.3f. is_final %d. duration %d ns", i,
-				result.stability(), result.is_final(),
-				result.result_end_time().nanos());
-			if (!result.is_final() && result.stability() < 0.5) {
-				obs_log(gf->log_level, "Google Result %d. Stability too low", i);
+// If text starts with prefix, ignoring whitespace and ASCII case, sets rest to what follows it
+static bool strip_prefix(const std::string &text, const std::string &prefix, std::string &rest)
+{
+	size_t t = 0;
+	for (const char c : prefix) {
+		if (isspace((unsigned char)c)) {
+			continue;
+		}
+		while (t < text.size() && isspace((unsigned char)text[t])) {
+			t++;
+		}
+		if (t == text.size() ||
+		    tolower((unsigned char)text[t]) != tolower((unsigned char)c)) {
+			return false;
+		}
+		t++;
+	}
+	while (t < text.size() && isspace((unsigned char)text[t])) {
+		t++;
+	}
+	rest = text.substr(t);
+	return true;
+}
+
+void GoogleProvider::handleResponse(RecognizeStream &stream,
+				    const StreamingRecognizeResponse &response)
+{
+	// result times are relative to the start of their stream
+	const uint64_t stream_offset_ms = samplesToMs(stream.start_sample);
+
+	// finalized text, and the interim text: the results at or above the stability threshold
+	// make its stable prefix, the ones below it the tail that is still being revised
+	std::string final_transcript;
+	std::string stable_transcript;
+	std::string unstable_tail;
+	uint64_t final_start_ms = 0;
+	uint64_t final_end_ms = 0;
+	uint64_t partial_start_ms = 0;
+	uint64_t partial_end_ms = 0;
+	// start time and offset in final_transcript of the words finalized here
+	std::vector<std::pair<uint64_t, size_t>> final_words;
+
+	for (int i = 0; i < response.results_size(); i++) {
+		const StreamingRecognitionResult &result = response.results(i);
+		const uint64_t result_end_ms =
+			stream_offset_ms + durationToMs(result.result_end_time());
+		// a result starts where the stream's previous final ended
+		const uint64_t result_audio_start_ms =
+			std::max(stream.results_end_ms, stream_offset_ms);
+		if (result.is_final()) {
+			stream.results_end_ms = result_end_ms;
+		}
+		obs_log(gf->log_level, "Google Result %d. stability %.3f. is_final %d. end %llu ms",
+			i, result.stability(), result.is_final(), result_end_ms);
+		if (result.alternatives_size() == 0) {
+			obs_log(gf->log_level, "Google Result %d. No alternatives", i);
+			continue;
+		}
+		if (result_end_ms <= committed_end_ms) {
+			// the previous stream already finalized this audio
+			obs_log(gf->log_level, "Google Result %d. Already committed", i);
+			continue;
+		}
+		const SpeechRecognitionAlternative &alternative = result.alternatives(0);
+		std::string transcript = alternative.transcript();
+		uint64_t result_start_ms = std::max(result_audio_start_ms, committed_end_ms);
+		// the transcript is cut, never rebuilt from its words: not every language separates
+		// words with spaces
+		size_t cut = 0;
+		std::vector<size_t> offsets;
+		int first_word = 0;
+		if (alternative.words_size() > 0) {
+			// skip the leading words the previous stream already emitted
+			auto word_start_ms = [&](int w) {
+				return stream_offset_ms +
+				       durationToMs(alternative.words(w).start_time());
+			};
+			while (first_word < alternative.words_size() &&
+			       word_start_ms(first_word) < committed_end_ms) {
+				first_word++;
+			}
+			if (first_word == alternative.words_size()) {
 				continue;
 			}
-			if (result.alternatives_size() == 0) {
-				obs_log(gf->log_level, "Google Result %d. No alternatives", i);
+			offsets = word_offsets(alternative);
+			if (first_word > 0 && !offsets.empty()) {
+				cut = offsets[first_word];
+				transcript = transcript.substr(cut);
+			} else if (first_word > 0) {
+				// the words are spelled differently in the transcript, as a last
+				// resort the remaining words are joined
+				transcript.clear();
+				for (int w = first_word; w < alternative.words_size(); w++) {
+					if (!transcript.empty()) {
+						transcript += " ";
+					}
+					transcript += alternative.words(w).word();
+				}
+			}
+			result_start_ms = word_start_ms(first_word);
+			if (result.is_final() && !offsets.empty()) {
+				for (int w = first_word; w < alternative.words_size(); w++) {
+					final_words.emplace_back(word_start_ms(w),
+								 final_transcript.size() +
+									 offsets[w] - cut);
+				}
+			}
+		} else if (result_audio_start_ms < committed_end_ms) {
+			// interim results carry no word times: cut the text the previous stream
+			// committed for the same audio
+			const std::string committed = committedTextSince(result_audio_start_ms);
+			std::string rest;
+			if (!committed.empty() && !strip_prefix(transcript, committed, rest)) {
+				if (!result.is_final()) {
+					// recognized differently, wait for the final's word times
+					obs_log(gf->log_level,
+						"Google Result %d. Overlaps committed text", i);
+					continue;
+				}
+			} else if (!committed.empty()) {
+				transcript = rest;
+			}
+			if (transcript.empty()) {
 				continue;
 			}
-			const SpeechRecognitionAlternative &alternative = result.alternatives(0);
-			std::string transcript = alternative.transcript();
-			obs_log(gf->log_level, "Google Transcription: '%s'", transcript.c_str());
-			overall_transcript += transcript;
-			is_final = result.is_final();
 		}
+		if (result.is_final() && offsets.empty()) {
+			final_words.emplace_back(result_start_ms, final_transcript.size());
+		}
+		obs_log(gf->log_level, "Google Transcription: '%s'", transcript.c_str());
+		if (result.is_final()) {
+			if (final_transcript.empty()) {
+				final_start_ms = result_start_ms;
+			}
+			final_transcript += transcript;
+			final_end_ms = result_end_ms;
+		} else {
+			if (stable_transcript.empty() && unstable_tail.empty()) {
+				partial_start_ms = result_start_ms;
+			}
+			if (result.stability() >= gf->partial_stability_threshold &&
+			    unstable_tail.empty()) {
+				stable_transcript += transcript;
+			} else {
+				unstable_tail += transcript;
+			}
+			partial_end_ms = result_end_ms;
+		}
+	}
 
+	auto emit = [this](const std::string &text, DetectionResult type, uint64_t start_ms,
+			   uint64_t end_ms) {
 		DetectionResultWithText result;
-		result.text = overall_transcript;
-		result.result = DETECTION_RESULT_SPEECH;
-		result.language = language_codes_from_underscore[gf->language];
+		result.text = text;
+		result.result = type;
+		result.language = language_code;
+		result.start_timestamp_ms = start_ms;
+		result.end_timestamp_ms = end_ms;
 		this->transcription_callback(result);
+	};
+
+	if (!final_transcript.empty()) {
+		committed_end_ms = final_end_ms;
+		rememberCommitted(final_transcript, final_words);
+		last_partial_transcript.clear();
+		emit(final_transcript, DETECTION_RESULT_SPEECH, final_start_ms, final_end_ms);
+	}
+
+	// the partial shows the stable prefix followed by the current tail, so the caption keeps
+	// up with the speaker. Interim responses often repeat the last one, those are dropped.
+	const std::string partial_transcript = stable_transcript + unstable_tail;
+	if (gf->partial_transcription && !partial_transcript.empty() &&
+	    partial_transcript != last_partial_transcript) {
+		obs_log(gf->log_level, "Google partial. stable '%s', tail '%s'",
+			stable_transcript.c_str(), unstable_tail.c_str());
+		last_partial_transcript = partial_transcript;
+		emit(partial_transcript, DETECTION_RESULT_PARTIAL, partial_start_ms,
+		     partial_end_ms);
+	}
+}
+
+void GoogleProvider::rememberCommitted(const std::string &text,
+				       const std::vector<std::pair<uint64_t, size_t>> &words)
+{
+	const size_t base = committed_text.size();
+	committed_text += text;
+	for (const auto &word : words) {
+		committed_words.emplace_back(word.first, base + word.second);
+	}
+	// forget what no stream can still repeat
+	while (!committed_words.empty() &&
+	       committed_words.front().first + COMMITTED_TEXT_KEEP_MS < committed_end_ms) {
+		committed_words.pop_front();
+	}
+	const size_t dropped = committed_words.empty() ? committed_text.size()
+						       : committed_words.front().second;
+	committed_text.erase(0, dropped);
+	for (auto &word : committed_words) {
+		word.second -= dropped;
 	}
 }
 
+std::string GoogleProvider::committedTextSince(uint64_t start_ms) const
+{
+	for (const auto &word : committed_words) {
+		if (word.first >= start_ms) {
+			return committed_text.substr(word.second);
+		}
+	}
+	return "";
+}
+
 void GoogleProvider::shutdown()
 {
-	// Shutdown the Clova provider
+	// Shutdown the Google provider
 	obs_log(gf->log_level, "Shutting down Google provider");
-	if (reader_writer && initialized) {
-		reader_writer->WritesDone();
+	if (initialized) {
+		std::vector<std::shared_ptr<RecognizeStream>> closing;
+		{
+			std::lock_guard<std::mutex> lock(streams_mutex);
+			for (const auto &stream : streams) {
+				if (!stream->writes_done) {
+					stream->writes_done = true;
+					closing.push_back(stream);
+				}
+			}
+		}
+		for (const auto &stream : closing) {
+			stream->reader_writer->WritesDone();
+		}
 	}
 	initialized = false;
 }
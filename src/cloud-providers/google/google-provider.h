@@ -4,15 +4,30 @@
 #include <grpcpp/grpcpp.h>
 #include "google/cloud/speech/v1/cloud_speech.grpc.pb.h"
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
 class GoogleProvider : public CloudProvider {
 public:
+	// a streaming request carries at most 25600 bytes of audio, 250 ms at 48 kHz PCM
+	static constexpr ProviderCapabilities capabilities = {
+		"google", 8000, 48000, AUDIO_ENCODING_PCM_S16LE | AUDIO_ENCODING_MULAW, true, 0,
+		100, 250};
+
 	GoogleProvider(TranscriptionCallback callback, cloudvocal_data *gf_)
 		: CloudProvider(callback, gf_),
-		  initialized(false),
 		  channel(nullptr),
 		  stub(nullptr),
-		  reader_writer(nullptr),
-		  chunk_id(1)
+		  initialized(false),
+		  chunk_id(1),
+		  samples_sent(0),
+		  committed_end_ms(0)
 	{
 		needs_results_thread = true;
 	}
@@ -25,13 +40,50 @@ protected:
 	virtual void shutdown() override;
 
 private:
+	typedef ::grpc::ClientReaderWriter<::google::cloud::speech::v1::StreamingRecognizeRequest,
+					   ::google::cloud::speech::v1::StreamingRecognizeResponse>
+		GoogleReaderWriter;
+
+	// A single StreamingRecognize call. Google ends these after about five minutes, so a
+	// session rotates through several of them, overlapping each with the next.
+	struct RecognizeStream {
+		grpc::ClientContext context;
+		std::unique_ptr<GoogleReaderWriter> reader_writer;
+		uint64_t start_sample; // session sample offset of the first sample sent here
+		std::chrono::steady_clock::time_point opened_at;
+		bool writes_done = false;
+		std::atomic<bool> failed = false;
+		// session time (ms) where the last final result of this stream ended, only used
+		// by the results thread
+		uint64_t results_end_ms = 0;
+	};
+
+	std::shared_ptr<RecognizeStream> openStream();
+	void rotateStreams();
+	void handleResponse(RecognizeStream &stream,
+			    const google::cloud::speech::v1::StreamingRecognizeResponse &response);
+	// Keeps the text of a final result, with the start time and offset of its words
+	void rememberCommitted(const std::string &text,
+			       const std::vector<std::pair<uint64_t, size_t>> &words);
+	// The committed text of the words starting at or after start_ms
+	std::string committedTextSince(uint64_t start_ms) const;
+	uint64_t samplesToMs(uint64_t samples) const;
+
 	std::shared_ptr<grpc::Channel> channel;
 	std::unique_ptr<google::cloud::speech::v1::Speech::Stub> stub;
-	grpc::ClientContext context;
-	std::unique_ptr<
-		::grpc::ClientReaderWriter<::google::cloud::speech::v1::StreamingRecognizeRequest,
-					   ::google::cloud::speech::v1::StreamingRecognizeResponse>>
-		reader_writer;
+	// open streams, oldest first. The back is the active stream, older ones are draining.
+	std::deque<std::shared_ptr<RecognizeStream>> streams;
+	std::mutex streams_mutex;
 	bool initialized;
 	uint64_t chunk_id;
+	// total samples sent in this session, the timeline all result times are mapped onto
+	uint64_t samples_sent;
+	// session time (ms) where the last final result ended
+	uint64_t committed_end_ms;
+	// recently committed text, and the start time and offset in it of each word. Interim
+	// results have no word times, so what a new stream repeats is cut by its text.
+	std::string committed_text;
+	std::deque<std::pair<uint64_t, size_t>> committed_words;
+	// last partial passed on, used to drop interim updates identical to it
+	std::string last_partial_transcript;
 };
@@ -9,7 +9,6 @@
 #include <iostream>
 
 #include "nlohmann/json.hpp"
-#include "language-codes/language-codes.h"
 
 namespace http = beast::http;
 using json = nlohmann::json;
@@ -97,8 +96,9 @@ bool RevAIProvider::init()
 	// Perform the websocket handshake
 	std::string query =
 		target_ + "?access_token=" + this->gf->cloud_provider_api_key +
-		"&content_type=audio/x-raw;layout=interleaved;rate=16000;format=S16LE;channels=1;" +
-		"language=" + language_codes_from_underscore[gf->language];
+		"&content_type=audio/x-raw;layout=interleaved;rate=" +
+		std::to_string(session.sample_rate) + ";format=S16LE;channels=1" +
+		"&language=" + language_code;
 
 	ws_.set_option(websocket::stream_base::decorator([&host](websocket::request_type &req) {
 		req.set(http::field::host, host);
@@ -112,10 +112,11 @@ bool RevAIProvider::init()
 void RevAIProvider::sendAudioBufferToTranscription(const std::deque<float> &audio_buffer)
 {
 	// Convert audio buffer to S16LE
-	std::vector<int16_t> converted = convertFloatToS16LE(audio_buffer);
+	encode_audio_samples(audio_buffer, session.encoding, audio_bytes_);
 
 	// Send audio buffer to Rev.ai
-	ws_.write(net::buffer(converted));
+	ws_.binary(true);
+	ws_.write(net::buffer(audio_bytes_));
 }
 
 // Receive and handle messages
@@ -171,7 +172,7 @@ void RevAIProvider::readResultsFromTranscription()
 		}
 
 		if (send_result) {
-			result.language = language_codes_from_underscore[gf->language];
+			result.language = language_code;
 			result.start_timestamp_ms = (uint64_t)response.ts;
 			result.end_timestamp_ms = (uint64_t)response.end_ts;
 			this->transcription_callback(result);
@@ -191,21 +192,9 @@ void RevAIProvider::readResultsFromTranscription()
 void RevAIProvider::shutdown()
 {
 	// Send EOS to signal end of stream
+	ws_.text(true);
 	ws_.write(net::buffer(std::string("EOS")));
 
 	// Close the WebSocket connection
 	ws_.close(websocket::close_code::normal);
 }
-
-std::vector<int16_t> RevAIProvider::convertFloatToS16LE(const std::deque<float> &audio_buffer)
-{
-	std::vector<int16_t> converted;
-	converted.reserve(audio_buffer.size());
-
-	for (float sample : audio_buffer) {
-		// Clamp to [-1.0, 1.0] and convert to S16LE
-		sample = std::fmaxf(-1.0f, std::fminf(1.0f, sample));
-		converted.push_back(static_cast<int16_t>(sample * 32767.0f));
-	}
-	return converted;
-}
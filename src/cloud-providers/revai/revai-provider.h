@@ -25,6 +25,9 @@ using tcp = boost::asio::ip::tcp;
 
 class RevAIProvider : public CloudProvider {
 public:
+	static constexpr ProviderCapabilities capabilities = {
+		"revai", 8000, 48000, AUDIO_ENCODING_PCM_S16LE, true, 0, 100, 1000};
+
 	RevAIProvider(TranscriptionCallback callback, cloudvocal_data *gf);
 
 	virtual bool init() override;
@@ -35,9 +38,6 @@ protected:
 	virtual void shutdown() override;
 
 private:
-	// Utility functions
-	std::vector<int16_t> convertFloatToS16LE(const std::deque<float> &audio_buffer);
-
 	// Member variables
 	bool is_connected;
 	std::string job_id;
@@ -45,6 +45,7 @@ private:
 	net::io_context ioc_;
 	ssl::context ctx_;
 	websocket::stream<beast::ssl_stream<tcp::socket>> ws_;
+	std::vector<uint8_t> audio_bytes_;
 	const std::string host_ = "api.rev.ai";
 	const std::string target_ = "/speechtotext/v1/stream";
 };
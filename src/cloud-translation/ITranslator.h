@@ -1,14 +1,32 @@
 #pragma once
+#include <functional>
 #include <string>
 #include <memory>
 #include <stdexcept>
+#include <vector>
+
+#include "translation-cloud.h"
 
 // Custom exception
 class TranslationError : public std::runtime_error {
 public:
-	explicit TranslationError(const std::string &message) : std::runtime_error(message) {}
+	explicit TranslationError(const std::string &message, long status_code = 0)
+		: std::runtime_error(message),
+		  status_code_(status_code)
+	{
+	}
+
+	// HTTP status of the failed response, 0 if the request got no response or did not fail
+	// on its status
+	long statusCode() const { return status_code_; }
+
+private:
+	long status_code_;
 };
 
+// Receives each new piece of a translation as it is generated
+typedef std::function<void(const std::string &delta)> TranslationDeltaCallback;
+
 // Abstract translator interface
 class ITranslator {
 public:
@@ -16,12 +34,66 @@ public:
 
 	virtual std::string translate(const std::string &text, const std::string &target_lang,
 				      const std::string &source_lang = "auto") = 0;
+
+	// Like translate, passing the translation to on_delta piece by piece while it is
+	// generated, and returning all of it at the end. The default passes the whole
+	// translation at once; translators whose API streams (see
+	// TranslatorCapabilities::streaming) override it.
+	virtual std::string translateStreaming(const std::string &text,
+					       const std::string &target_lang,
+					       const std::string &source_lang,
+					       const TranslationDeltaCallback &on_delta)
+	{
+		std::string translation = translate(text, target_lang, source_lang);
+		if (on_delta) {
+			on_delta(translation);
+		}
+		return translation;
+	}
+
+	// Translates text into each of target_langs, results in the same order. The default sends
+	// one request per language; translators whose API takes several targets at once (see
+	// TranslatorCapabilities::multi_target) override it with a single request.
+	virtual std::vector<std::string>
+	translateMulti(const std::string &text, const std::vector<std::string> &target_langs,
+		       const std::string &source_lang = "auto")
+	{
+		std::vector<std::string> results;
+		for (const std::string &target_lang : target_langs) {
+			results.push_back(translate(text, target_lang, source_lang));
+		}
+		return results;
+	}
+
+	// Remembers a finished sentence and its translation as context for the sentences that
+	// follow. Translators that translate each sentence on its own ignore it.
+	virtual void addContext(const std::string &text, const std::string &translation,
+				const std::string &target_lang,
+				const std::string &source_lang = "auto")
+	{
+		(void)text;
+		(void)translation;
+		(void)target_lang;
+		(void)source_lang;
+	}
+
+	// Translates each of texts, results in the same order. The default sends one request per
+	// text; translators whose API takes several texts at once (see
+	// TranslatorCapabilities::max_batch_size) override it with a single request.
+	virtual std::vector<std::string> translateBatch(const std::vector<std::string> &texts,
+							const std::string &target_lang,
+							const std::string &source_lang = "auto")
+	{
+		std::vector<std::string> results;
+		for (const std::string &text : texts) {
+			results.push_back(translate(text, target_lang, source_lang));
+		}
+		return results;
+	}
 };
 
-// Factory function declaration
-std::unique_ptr<ITranslator> createTranslator(const std::string &provider,
-					      const std::string &api_key,
-					      const std::string &location = "");
+// Creates the translator selected in the config. Throws TranslationError for an unknown provider.
+std::unique_ptr<ITranslator> createTranslator(const CloudTranslatorConfig &config);
 
 inline std::string sanitize_language_code(const std::string &lang_code)
 {
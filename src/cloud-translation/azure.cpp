@@ -16,81 +16,91 @@ AzureTranslator::AzureTranslator(const std::string &api_key, const std::string &
 
 AzureTranslator::~AzureTranslator() = default;
 
+std::unique_ptr<ITranslator> AzureTranslator::create(const CloudTranslatorConfig &config)
+{
+	return std::make_unique<AzureTranslator>(config.access_key, config.region);
+}
+
 std::string AzureTranslator::translate(const std::string &text, const std::string &target_lang,
 				       const std::string &source_lang)
 {
-	std::unique_ptr<CURL, decltype(&curl_easy_cleanup)> curl(curl_easy_init(),
-								 curl_easy_cleanup);
+	return translateMulti(text, {target_lang}, source_lang)[0];
+}
 
-	if (!curl) {
-		throw TranslationError("Failed to initialize CURL session");
-	}
+std::vector<std::string>
+AzureTranslator::translateMulti(const std::string &text,
+				const std::vector<std::string> &target_langs,
+				const std::string &source_lang)
+{
+	return request({text}, target_langs, source_lang)[0];
+}
 
-	std::string response;
+std::vector<std::string> AzureTranslator::translateBatch(const std::vector<std::string> &texts,
+							 const std::string &target_lang,
+							 const std::string &source_lang)
+{
+	std::vector<std::string> results;
+	for (const std::vector<std::string> &translations :
+	     request(texts, {target_lang}, source_lang)) {
+		results.push_back(translations[0]);
+	}
+	return results;
+}
 
+std::vector<std::vector<std::string>>
+AzureTranslator::request(const std::vector<std::string> &texts,
+			 const std::vector<std::string> &target_langs,
+			 const std::string &source_lang)
+{
 	try {
 		// Construct the route
 		std::stringstream route;
-		route << "/translate?api-version=3.0"
-		      << "&to=" << sanitize_language_code(target_lang);
+		route << "/translate?api-version=3.0";
+		for (const std::string &target_lang : target_langs) {
+			route << "&to=" << sanitize_language_code(target_lang);
+		}
 
 		if (source_lang != "auto") {
 			route << "&from=" << sanitize_language_code(source_lang);
 		}
 
 		// Create the request body
-		json body = json::array({{{"Text", text}}});
-		std::string requestBody = body.dump();
-
-		// Construct full URL
-		std::string url = endpoint_ + route.str();
-
-		// Set up curl options
-		curl_easy_setopt(curl.get(), CURLOPT_URL, url.c_str());
-		curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, CurlHelper::WriteCallback);
-		curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, &response);
-		curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYPEER, 1L);
-		curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYHOST, 2L);
-		curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT, 30L);
-
-		// Set up POST request
-		curl_easy_setopt(curl.get(), CURLOPT_POST, 1L);
-		curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDS, requestBody.c_str());
-
-		// Set up headers
-		struct curl_slist *headers = nullptr;
-		headers = curl_slist_append(headers, "Content-Type: application/json");
+		json body = json::array();
+		for (const std::string &text : texts) {
+			body.push_back({{"Text", text}});
+		}
 
-		std::string auth_header = "Ocp-Apim-Subscription-Key: " + api_key_;
-		headers = curl_slist_append(headers, auth_header.c_str());
+		HttpRequest request;
+		request.url = endpoint_ + route.str();
+		request.post = true;
+		request.body = body.dump();
+		request.headers = {"Content-Type: application/json",
+				   "Ocp-Apim-Subscription-Key: " + api_key_};
 
 		// Add location header if provided
 		if (!location_.empty()) {
-			std::string location_header = "Ocp-Apim-Subscription-Region: " + location_;
-			headers = curl_slist_append(headers, location_header.c_str());
+			request.headers.push_back("Ocp-Apim-Subscription-Region: " + location_);
 		}
 
-		curl_easy_setopt(curl.get(), CURLOPT_HTTPHEADER, headers);
-
-		// Perform request
-		CURLcode res = curl_easy_perform(curl.get());
+		HttpResponse response = curl_helper_->perform(request);
 
-		// Clean up headers
-		curl_slist_free_all(headers);
-
-		if (res != CURLE_OK) {
+		if (response.result != CURLE_OK) {
 			throw TranslationError(std::string("CURL request failed: ") +
-					       curl_easy_strerror(res));
+					       curl_easy_strerror(response.result));
+		}
+		if (response.status_code == 429) {
+			throw TranslationError("HTTP error: 429 Too Many Requests", 429);
 		}
 
-		return parseResponse(response);
-
+		return parseResponse(response.body, texts.size(), target_langs.size());
 	} catch (const json::exception &e) {
 		throw TranslationError(std::string("JSON parsing error: ") + e.what());
 	}
 }
 
-std::string AzureTranslator::parseResponse(const std::string &response_str)
+std::vector<std::vector<std::string>>
+AzureTranslator::parseResponse(const std::string &response_str, size_t text_count,
+			       size_t target_count)
 {
 	try {
 		json response = json::parse(response_str);
@@ -102,10 +112,29 @@ std::string AzureTranslator::parseResponse(const std::string &response_str)
 					       error.value("message", "Unknown error"));
 		}
 
-		// Azure returns an array of translations
-		// Each translation can have multiple target languages
-		// We'll take the first translation's first target
-		return response[0]["translations"][0]["text"].get<std::string>();
+		// Azure returns an array of translations, one per input text, each with one
+		// entry per target language in the order of the `to` parameters
+		if (!response.is_array() || response.size() != text_count) {
+			throw TranslationError("Azure API Error: expected " +
+					       std::to_string(text_count) + " results, got " +
+					       std::to_string(response.size()));
+		}
+		std::vector<std::vector<std::string>> results;
+		for (const json &result : response) {
+			const json &translations = result["translations"];
+			if (translations.size() != target_count) {
+				throw TranslationError("Azure API Error: expected " +
+						       std::to_string(target_count) +
+						       " translations, got " +
+						       std::to_string(translations.size()));
+			}
+			std::vector<std::string> texts;
+			for (const json &translation : translations) {
+				texts.push_back(translation["text"].get<std::string>());
+			}
+			results.push_back(texts);
+		}
+		return results;
 
 	} catch (const json::exception &e) {
 		throw TranslationError(std::string("Failed to parse Azure response: ") + e.what());
@@ -6,6 +6,9 @@ class CurlHelper; // Forward declaration
 
 class AzureTranslator : public ITranslator {
 public:
+	static constexpr TranslatorCapabilities capabilities = {"azure", 1000, 50000, true, false};
+	static std::unique_ptr<ITranslator> create(const CloudTranslatorConfig &config);
+
 	AzureTranslator(
 		const std::string &api_key, const std::string &location = "",
 		const std::string &endpoint = "https://api.cognitive.microsofttranslator.com");
@@ -13,9 +16,23 @@ public:
 
 	std::string translate(const std::string &text, const std::string &target_lang,
 			      const std::string &source_lang = "auto") override;
+	// One request with a `to` parameter per target language
+	std::vector<std::string> translateMulti(const std::string &text,
+						const std::vector<std::string> &target_langs,
+						const std::string &source_lang = "auto") override;
+	// One request with all texts in the body array
+	std::vector<std::string> translateBatch(const std::vector<std::string> &texts,
+						const std::string &target_lang,
+						const std::string &source_lang = "auto") override;
 
 private:
-	std::string parseResponse(const std::string &response_str);
+	// Translates every text into every target language, indexed [text][target]
+	std::vector<std::vector<std::string>> request(const std::vector<std::string> &texts,
+						      const std::vector<std::string> &target_langs,
+						      const std::string &source_lang);
+	std::vector<std::vector<std::string>> parseResponse(const std::string &response_str,
+							    size_t text_count,
+							    size_t target_count);
 
 	std::string api_key_;
 	std::string location_;
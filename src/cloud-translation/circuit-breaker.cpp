@@ -0,0 +1,90 @@
+#include "circuit-breaker.h"
+
+#include <algorithm>
+
+#include <obs-module.h>
+#include "plugin-support.h"
+
+// Keys start with the provider id, the rest of the key is not needed in the log
+static std::string provider_of(const std::string &key)
+{
+	return key.substr(0, key.find('|'));
+}
+
+CircuitBreaker &CircuitBreaker::instance()
+{
+	static CircuitBreaker breaker;
+	return breaker;
+}
+
+bool CircuitBreaker::allow(const std::string &key)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = states_.find(key);
+	if (it == states_.end() || !it->second.open) {
+		return true;
+	}
+	State &state = it->second;
+	if (state.probing || std::chrono::steady_clock::now() < state.open_until) {
+		metrics_.rejected++;
+		return false;
+	}
+	// half open, let one request through to see whether the endpoint recovered
+	state.probing = true;
+	return true;
+}
+
+void CircuitBreaker::recordSuccess(const std::string &key)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = states_.find(key);
+	if (it == states_.end()) {
+		return;
+	}
+	if (it->second.open) {
+		obs_log(LOG_INFO, "Translation provider %s recovered", provider_of(key).c_str());
+	}
+	states_.erase(it);
+}
+
+void CircuitBreaker::recordFailure(const std::string &key, bool rate_limited)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	State &state = states_[key];
+	state.failures++;
+	if (state.open) {
+		if (state.probing) {
+			// the probe failed, back off further
+			state.probing = false;
+			state.open_time = std::min(state.open_time * 2,
+						   std::chrono::seconds(MAX_OPEN_TIME));
+			state.open_until = std::chrono::steady_clock::now() + state.open_time;
+		}
+		return;
+	}
+	if (rate_limited || state.failures >= FAILURE_THRESHOLD) {
+		state.open = true;
+		state.open_time = OPEN_TIME;
+		state.open_until = std::chrono::steady_clock::now() + state.open_time;
+		metrics_.opened++;
+		obs_log(LOG_WARNING, "Translation provider %s %s, skipping it for %d seconds",
+			provider_of(key).c_str(),
+			rate_limited ? "is rate limiting" : "keeps failing",
+			(int)state.open_time.count());
+	}
+}
+
+void CircuitBreaker::release(const std::string &key)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = states_.find(key);
+	if (it != states_.end()) {
+		it->second.probing = false;
+	}
+}
+
+CircuitBreaker::Metrics CircuitBreaker::metrics()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return metrics_;
+}
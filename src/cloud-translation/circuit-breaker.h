@@ -0,0 +1,51 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Health of each provider endpoint. After FAILURE_THRESHOLD failures in a row, or a single
+// rate limit response, the breaker opens and requests skip the endpoint, going to the next
+// provider of the chain instead of waiting on it. Once the open time has passed a single
+// probe request is let through: if it succeeds the breaker closes, if it fails the breaker
+// opens again for twice as long.
+class CircuitBreaker {
+public:
+	struct Metrics {
+		uint64_t opened = 0;   // times a breaker opened
+		uint64_t rejected = 0; // requests that skipped an open breaker
+	};
+
+	static constexpr uint32_t FAILURE_THRESHOLD = 3;
+	static constexpr std::chrono::seconds OPEN_TIME{10};
+	static constexpr std::chrono::seconds MAX_OPEN_TIME{300};
+
+	static CircuitBreaker &instance();
+
+	// True if a request may be sent to the endpoint. Each allowed request must be followed
+	// by recordSuccess, recordFailure or release.
+	bool allow(const std::string &key);
+
+	void recordSuccess(const std::string &key);
+	// A rate limited request opens the breaker right away
+	void recordFailure(const std::string &key, bool rate_limited);
+	// The request neither succeeded nor failed, e.g. it was cancelled
+	void release(const std::string &key);
+
+	Metrics metrics();
+
+private:
+	struct State {
+		uint32_t failures = 0;
+		bool open = false;
+		bool probing = false; // a probe request is in flight
+		std::chrono::steady_clock::time_point open_until;
+		std::chrono::seconds open_time{0};
+	};
+
+	std::mutex mutex_;
+	std::unordered_map<std::string, State> states_;
+	Metrics metrics_;
+};
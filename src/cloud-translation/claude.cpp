@@ -1,5 +1,6 @@
 #include "claude.h"
 #include "utils/curl-helper.h"
+#include "utils/sse-parser.h"
 #include <nlohmann/json.hpp>
 #include <sstream>
 #include <unordered_map>
@@ -18,6 +19,13 @@ ClaudeTranslator::ClaudeTranslator(const std::string &api_key, const std::string
 
 ClaudeTranslator::~ClaudeTranslator() = default;
 
+std::unique_ptr<ITranslator> ClaudeTranslator::create(const CloudTranslatorConfig &config)
+{
+	return std::make_unique<ClaudeTranslator>(config.access_key,
+						  config.model.empty() ? "claude-3-sonnet-20240229"
+								       : config.model);
+}
+
 std::string ClaudeTranslator::createSystemPrompt(const std::string &target_lang) const
 {
 	std::string target_language = getLanguageName(target_lang);
@@ -28,8 +36,48 @@ std::string ClaudeTranslator::createSystemPrompt(const std::string &target_lang)
 	       "Maintain any formatting, line breaks, or special characters from the original text.";
 }
 
-std::string ClaudeTranslator::translate(const std::string &text, const std::string &target_lang,
-					const std::string &source_lang)
+std::string ClaudeTranslator::createUserMessage(const std::string &text,
+						const std::string &source_lang) const
+{
+	// the source language is named in the system prompt
+	(void)source_lang;
+	return text;
+}
+
+std::string ClaudeTranslator::requestPrefix(const std::string &target_lang,
+					    const std::string &source_lang, bool stream)
+{
+	const std::string key = target_lang + '\n' + source_lang + (stream ? "\ns" : "");
+	std::lock_guard<std::mutex> lock(prefixes_mutex_);
+	auto it = prefixes_.find(key);
+	if (it != prefixes_.end()) {
+		return it->second;
+	}
+
+	std::string system_prompt = createSystemPrompt(target_lang);
+	if (source_lang != "auto") {
+		system_prompt += " The source text is in " + getLanguageName(source_lang) + ".";
+	}
+	// the system prompt is marked for prompt caching, together with the context that
+	// follows it once that is long enough to be cached
+	json head = {{"model", model_},
+		     {"max_tokens", 4096},
+		     {"system", json::array({{{"type", "text"},
+					       {"text", system_prompt},
+					       {"cache_control", {{"type", "ephemeral"}}}}})}};
+	if (stream) {
+		head["stream"] = true;
+	}
+	// the messages array is left open for the context and the new message
+	std::string prefix = head.dump();
+	prefix.pop_back();
+	prefix += ",\"messages\":[";
+	return prefixes_.emplace(key, prefix).first->second;
+}
+
+std::string ClaudeTranslator::createRequestBody(const std::string &text,
+						const std::string &target_lang,
+						const std::string &source_lang, bool stream)
 {
 	if (!isLanguageSupported(target_lang)) {
 		throw TranslationError("Unsupported target language: " + target_lang);
@@ -39,76 +87,98 @@ std::string ClaudeTranslator::translate(const std::string &text, const std::stri
 		throw TranslationError("Unsupported source language: " + source_lang);
 	}
 
-	std::unique_ptr<CURL, decltype(&curl_easy_cleanup)> curl(curl_easy_init(),
-								 curl_easy_cleanup);
-
-	if (!curl) {
-		throw TranslationError("Failed to initialize CURL session");
+	try {
+		// The cache breakpoint on the new message caches the whole conversation. The
+		// next request finds it again up to where this message was, as that has become
+		// part of its context.
+		const json message = {
+			{"role", "user"},
+			{"content", json::array({{{"type", "text"},
+						  {"text", createUserMessage(text, source_lang)},
+						  {"cache_control", {{"type", "ephemeral"}}}}})}};
+		return requestPrefix(target_lang, source_lang, stream) +
+		       context_.messages(target_lang + '\n' + source_lang) + message.dump() + "]}";
+	} catch (const json::exception &e) {
+		throw TranslationError(std::string("JSON parsing error: ") + e.what());
 	}
+}
 
-	std::string response;
+void ClaudeTranslator::addContext(const std::string &text, const std::string &translation,
+				  const std::string &target_lang, const std::string &source_lang)
+{
+	context_.add(target_lang + '\n' + source_lang, createUserMessage(text, source_lang),
+		     translation);
+}
 
-	try {
-		// Prepare the request
-		std::string url = "https://api.anthropic.com/v1/messages";
-
-		// Create request body
-		json request_body = {{"model", model_},
-				     {"max_tokens", 4096},
-				     {"system", createSystemPrompt(target_lang)},
-				     {"messages",
-				      json::array({{{"role", "user"}, {"content", text}}})}};
-
-		if (source_lang != "auto") {
-			request_body["system"] = createSystemPrompt(target_lang) +
-						 " The source text is in " +
-						 getLanguageName(source_lang) + ".";
-		}
+std::string ClaudeTranslator::post(const std::string &body,
+				   std::function<void(const char *, size_t)> on_data)
+{
+	HttpRequest request;
+	request.url = "https://api.anthropic.com/v1/messages";
+	request.post = true;
+	request.body = body;
+	request.headers = {"Content-Type: application/json", "x-api-key: " + api_key_,
+			   "anthropic-version: 2023-06-01"};
+	request.on_data = std::move(on_data);
+
+	HttpResponse response = curl_helper_->perform(request);
+
+	if (response.result != CURLE_OK) {
+		throw TranslationError(std::string("CURL request failed: ") +
+				       curl_easy_strerror(response.result));
+	}
 
-		std::string payload = request_body.dump();
-
-		// Set up headers
-		struct curl_slist *headers = nullptr;
-		headers = curl_slist_append(headers, "Content-Type: application/json");
-		headers = curl_slist_append(headers, ("x-api-key: " + api_key_).c_str());
-		headers = curl_slist_append(headers, "anthropic-version: 2023-06-01");
-
-		// Set up CURL request
-		curl_easy_setopt(curl.get(), CURLOPT_URL, url.c_str());
-		curl_easy_setopt(curl.get(), CURLOPT_POST, 1L);
-		curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDS, payload.c_str());
-		curl_easy_setopt(curl.get(), CURLOPT_HTTPHEADER, headers);
-		curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, CurlHelper::WriteCallback);
-		curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, &response);
-		curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYPEER, 1L);
-		curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYHOST, 2L);
-		curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT, 30L);
-
-		// Perform request
-		CURLcode res = curl_easy_perform(curl.get());
-
-		// Clean up
-		curl_slist_free_all(headers);
-
-		if (res != CURLE_OK) {
-			throw TranslationError(std::string("CURL request failed: ") +
-					       curl_easy_strerror(res));
-		}
+	// Check HTTP response code
+	if (response.status_code != 200) {
+		throw TranslationError("HTTP error: " + std::to_string(response.status_code) +
+					       "\nResponse: " + response.body,
+				       response.status_code);
+	}
+	return response.body;
+}
 
-		// Check HTTP response code
-		long response_code;
-		curl_easy_getinfo(curl.get(), CURLINFO_RESPONSE_CODE, &response_code);
+std::string ClaudeTranslator::translate(const std::string &text, const std::string &target_lang,
+					const std::string &source_lang)
+{
+	return parseResponse(post(createRequestBody(text, target_lang, source_lang, false)));
+}
 
-		if (response_code != 200) {
-			throw TranslationError("HTTP error: " + std::to_string(response_code) +
-					       "\nResponse: " + response);
+std::string ClaudeTranslator::translateStreaming(const std::string &text,
+						 const std::string &target_lang,
+						 const std::string &source_lang,
+						 const TranslationDeltaCallback &on_delta)
+{
+	std::string translation;
+	std::string error;
+	// the text arrives in content_block_delta events, an error event ends the stream early
+	SseParser parser([&](const std::string &, const std::string &data) {
+		json event = json::parse(data, nullptr, false);
+		if (event.is_discarded() || !event.is_object()) {
+			return;
+		}
+		const std::string type = event.value("type", "");
+		if (type == "error") {
+			const json &details = event.value("error", json::object());
+			error = details.value("message", "Unknown error");
+		} else if (type == "content_block_delta") {
+			const json &delta = event.value("delta", json::object());
+			if (delta.value("type", "") == "text_delta") {
+				const std::string piece = delta.value("text", "");
+				translation += piece;
+				if (on_delta && !piece.empty()) {
+					on_delta(piece);
+				}
+			}
 		}
+	});
 
-		return parseResponse(response);
+	post(createRequestBody(text, target_lang, source_lang, true),
+	     [&parser](const char *data, size_t size) { parser.feed(data, size); });
 
-	} catch (const json::exception &e) {
-		throw TranslationError(std::string("JSON parsing error: ") + e.what());
+	if (!error.empty()) {
+		throw TranslationError("Claude API Error: " + error);
 	}
+	return translation;
 }
 
 std::string ClaudeTranslator::parseResponse(const std::string &response_str)
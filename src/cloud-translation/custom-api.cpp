@@ -1,8 +1,7 @@
 #include "custom-api.h"
 #include "utils/curl-helper.h"
 #include <nlohmann/json.hpp>
-#include <sstream>
-#include <regex>
+#include <cstdio>
 #include <stdexcept>
 
 using json = nlohmann::json;
@@ -11,102 +10,199 @@ CustomApiTranslator::CustomApiTranslator(const std::string &endpoint,
 					 const std::string &body_template,
 					 const std::string &response_json_path)
 	: endpoint_(endpoint),
-	  body_template_(body_template),
+	  body_template_(parseTemplate(body_template)),
 	  response_json_path_(response_json_path),
 	  curl_helper_(std::make_unique<CurlHelper>())
 {
+	for (const Segment &segment : body_template_) {
+		literal_size_ += segment.literal.size();
+	}
+	try {
+		response_pointer_ = parseResponsePath(response_json_path);
+	} catch (const json::exception &e) {
+		throw TranslationError("Invalid response JSON path '" + response_json_path +
+				       "': " + e.what());
+	}
 }
 
 CustomApiTranslator::~CustomApiTranslator() = default;
 
-std::string CustomApiTranslator::translate(const std::string &text, const std::string &target_lang,
-					   const std::string &source_lang)
+std::unique_ptr<ITranslator> CustomApiTranslator::create(const CloudTranslatorConfig &config)
 {
-	// first encode text to JSON compatible string
-	nlohmann::json tmp = text;
-	std::string textStr = tmp.dump();
-	// remove '"' from the beginning and end of the string
-	textStr = textStr.substr(1, textStr.size() - 2);
-	// then replace the placeholders in the body template
-	std::unordered_map<std::string, std::string> values = {
-		{"\\{\\{sentence\\}\\}", textStr},
-		{"\\{\\{target_lang\\}\\}", target_lang},
-		{"\\{\\{source_lang\\}\\}", source_lang}};
-
-	std::string body = replacePlaceholders(body_template_, values);
-	std::string response;
-
-	std::unique_ptr<CURL, decltype(&curl_easy_cleanup)> curl(curl_easy_init(),
-								 curl_easy_cleanup);
+	return std::make_unique<CustomApiTranslator>(config.endpoint, config.body,
+						     config.response_json_path);
+}
 
-	if (!curl) {
-		throw std::runtime_error("Failed to initialize CURL session");
+std::vector<CustomApiTranslator::Segment>
+CustomApiTranslator::parseTemplate(const std::string &template_str)
+{
+	std::vector<Segment> segments;
+	std::string literal;
+	size_t pos = 0;
+	while (pos < template_str.size()) {
+		const size_t open = template_str.find("{{", pos);
+		const size_t close = open == std::string::npos ? std::string::npos
+							       : template_str.find("}}", open + 2);
+		if (close == std::string::npos) {
+			literal.append(template_str, pos, std::string::npos);
+			break;
+		}
+		literal.append(template_str, pos, open - pos);
+		const std::string name = template_str.substr(open + 2, close - open - 2);
+		Segment::Kind kind;
+		if (name == "sentence") {
+			kind = Segment::SENTENCE;
+		} else if (name == "target_lang" || name == "target_language") {
+			kind = Segment::TARGET_LANG;
+		} else if (name == "source_lang" || name == "source_language") {
+			kind = Segment::SOURCE_LANG;
+		} else {
+			literal.append(template_str, open, close + 2 - open);
+			pos = close + 2;
+			continue;
+		}
+		if (!literal.empty()) {
+			segments.push_back({Segment::LITERAL, literal});
+			literal.clear();
+		}
+		segments.push_back({kind, ""});
+		pos = close + 2;
 	}
+	if (!literal.empty()) {
+		segments.push_back({Segment::LITERAL, literal});
+	}
+	return segments;
+}
 
-	try {
-		// Set up curl options
-		curl_easy_setopt(curl.get(), CURLOPT_URL, endpoint_.c_str());
-		curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, CurlHelper::WriteCallback);
-		curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, &response);
-		curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYPEER, 1L);
-		curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYHOST, 2L);
-		curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT, 30L);
-
-		// Set up POST request
-		curl_easy_setopt(curl.get(), CURLOPT_POST, 1L);
-		curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDS, body.c_str());
-
-		// Set up headers
-		struct curl_slist *headers = nullptr;
-		headers = curl_slist_append(headers, "Content-Type: application/json");
-		curl_easy_setopt(curl.get(), CURLOPT_HTTPHEADER, headers);
-
-		// Perform request
-		CURLcode res = curl_easy_perform(curl.get());
-
-		// Clean up headers
-		curl_slist_free_all(headers);
-
-		if (res != CURLE_OK) {
-			throw TranslationError(std::string("CURL request failed: ") +
-					       curl_easy_strerror(res));
+json::json_pointer CustomApiTranslator::parseResponsePath(const std::string &path)
+{
+	if (path.empty() || path[0] == '/') {
+		return json::json_pointer(path);
+	}
+	// dotted path, each part becomes a pointer token with '~' and '/' escaped
+	std::string pointer;
+	size_t start = 0;
+	for (;;) {
+		const size_t dot = path.find('.', start);
+		pointer += '/';
+		for (char c : path.substr(start, dot == std::string::npos ? dot : dot - start)) {
+			if (c == '~') {
+				pointer += "~0";
+			} else if (c == '/') {
+				pointer += "~1";
+			} else {
+				pointer += c;
+			}
 		}
+		if (dot == std::string::npos) {
+			break;
+		}
+		start = dot + 1;
+	}
+	return json::json_pointer(pointer);
+}
 
-		return parseResponse(response);
-
-	} catch (const std::exception &e) {
-		throw TranslationError(std::string("JSON parsing error: ") + e.what());
+// Appends text as the contents of a JSON string, without the quotes
+static void append_json_escaped(std::string &out, const std::string &text)
+{
+	for (char c : text) {
+		switch (c) {
+		case '"':
+			out += "\\\"";
+			break;
+		case '\\':
+			out += "\\\\";
+			break;
+		case '\n':
+			out += "\\n";
+			break;
+		case '\r':
+			out += "\\r";
+			break;
+		case '\t':
+			out += "\\t";
+			break;
+		case '\b':
+			out += "\\b";
+			break;
+		case '\f':
+			out += "\\f";
+			break;
+		default:
+			if ((unsigned char)c < 0x20) {
+				char escaped[7];
+				snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned int)c);
+				out += escaped;
+			} else {
+				out += c;
+			}
+		}
 	}
 }
 
-std::string CustomApiTranslator::replacePlaceholders(
-	const std::string &template_str,
-	const std::unordered_map<std::string, std::string> &values) const
+std::string CustomApiTranslator::renderBody(const std::string &text,
+					    const std::string &target_lang,
+					    const std::string &source_lang) const
 {
-	std::string result = template_str;
-	for (const auto &pair : values) {
-		try {
-			std::regex placeholder(pair.first);
-			result = std::regex_replace(result, placeholder, pair.second);
-		} catch (const std::regex_error &e) {
-			// Handle regex error
-			throw TranslationError(std::string("Regex error: ") + e.what());
+	const std::string target = sanitize_language_code(target_lang);
+	const std::string source = sanitize_language_code(source_lang);
+	std::string body;
+	// room for the sentence with a few escapes
+	body.reserve(literal_size_ + text.size() + text.size() / 8 + 2 * 8);
+	for (const Segment &segment : body_template_) {
+		switch (segment.kind) {
+		case Segment::LITERAL:
+			body += segment.literal;
+			break;
+		case Segment::SENTENCE:
+			append_json_escaped(body, text);
+			break;
+		case Segment::TARGET_LANG:
+			body += target;
+			break;
+		case Segment::SOURCE_LANG:
+			body += source;
+			break;
 		}
 	}
-	return result;
+	return body;
 }
 
-std::string CustomApiTranslator::parseResponse(const std::string &response_str)
+std::string CustomApiTranslator::translate(const std::string &text, const std::string &target_lang,
+					   const std::string &source_lang)
 {
-	try {
-		// parse the JSON response
-		json response = json::parse(response_str);
+	HttpRequest request;
+	request.url = endpoint_;
+	request.post = true;
+	request.body = renderBody(text, target_lang, source_lang);
+	request.headers = {"Content-Type: application/json"};
 
-		// extract the translation from the JSON response
-		std::string response_out = response[response_json_path_];
+	HttpResponse response = curl_helper_->perform(request);
 
-		return response_out;
+	if (response.result != CURLE_OK) {
+		throw TranslationError(std::string("CURL request failed: ") +
+				       curl_easy_strerror(response.result));
+	}
+	if (response.status_code == 429) {
+		throw TranslationError("HTTP error: 429 Too Many Requests", 429);
+	}
+
+	return parseResponse(response.body);
+}
+
+std::string CustomApiTranslator::parseResponse(const std::string &response_str)
+{
+	json response;
+	try {
+		response = json::parse(response_str);
 	} catch (const json::exception &e) {
 		throw TranslationError(std::string("JSON parsing error: ") + e.what());
 	}
+	try {
+		// extract the translation from the JSON response
+		return response.at(response_pointer_).get<std::string>();
+	} catch (const json::exception &e) {
+		throw TranslationError("Translation not found at '" + response_json_path_ +
+				       "' in the response: " + e.what());
+	}
 }
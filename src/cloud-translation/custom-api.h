@@ -2,12 +2,17 @@
 #include "ITranslator.h"
 #include <memory>
 #include <string>
-#include <unordered_map>
+#include <vector>
+
+#include <nlohmann/json.hpp>
 
 class CurlHelper; // Forward declaration
 
 class CustomApiTranslator : public ITranslator {
 public:
+	static constexpr TranslatorCapabilities capabilities = {"api", 1, 0, false, false};
+	static std::unique_ptr<ITranslator> create(const CloudTranslatorConfig &config);
+
 	explicit CustomApiTranslator(const std::string &endpoint, const std::string &body_template,
 				     const std::string &response_json_path);
 	~CustomApiTranslator() override;
@@ -16,13 +21,26 @@ public:
 			      const std::string &source_lang = "auto") override;
 
 private:
-	std::string
-	replacePlaceholders(const std::string &template_str,
-			    const std::unordered_map<std::string, std::string> &values) const;
+	// A piece of the body template, either literal text or a placeholder
+	struct Segment {
+		enum Kind { LITERAL, SENTENCE, TARGET_LANG, SOURCE_LANG };
+		Kind kind;
+		std::string literal;
+	};
+
+	// Splits the template at its {{...}} placeholders, unknown placeholders are kept as text
+	static std::vector<Segment> parseTemplate(const std::string &template_str);
+	// "a.0.b" or the JSON pointer "/a/0/b"
+	static nlohmann::json::json_pointer parseResponsePath(const std::string &path);
+
+	std::string renderBody(const std::string &text, const std::string &target_lang,
+			       const std::string &source_lang) const;
 	std::string parseResponse(const std::string &response_str);
 
 	std::string endpoint_;
-	std::string body_template_;
+	std::vector<Segment> body_template_;
+	size_t literal_size_ = 0; // length of the template without its placeholders
 	std::string response_json_path_;
+	nlohmann::json::json_pointer response_pointer_;
 	std::unique_ptr<CurlHelper> curl_helper_;
 };
@@ -14,86 +14,66 @@ DeepLTranslator::DeepLTranslator(const std::string &api_key, bool free)
 
 DeepLTranslator::~DeepLTranslator() = default;
 
+std::unique_ptr<ITranslator> DeepLTranslator::create(const CloudTranslatorConfig &config)
+{
+	return std::make_unique<DeepLTranslator>(config.access_key, config.free);
+}
+
 std::string DeepLTranslator::translate(const std::string &text, const std::string &target_lang,
 				       const std::string &source_lang)
 {
-	std::unique_ptr<CURL, decltype(&curl_easy_cleanup)> curl(curl_easy_init(),
-								 curl_easy_cleanup);
+	return translateBatch({text}, target_lang, source_lang)[0];
+}
 
-	if (!curl) {
-		throw TranslationError("DeepL Failed to initialize CURL session");
+std::vector<std::string> DeepLTranslator::translateBatch(const std::vector<std::string> &texts,
+							 const std::string &target_lang,
+							 const std::string &source_lang)
+{
+	// Note: DeepL uses uppercase language codes
+	std::string upperTarget = sanitize_language_code(target_lang);
+	std::string upperSource = sanitize_language_code(source_lang);
+	for (char &c : upperTarget)
+		c = (char)std::toupper((int)c);
+	for (char &c : upperSource)
+		c = (char)std::toupper((int)c);
+
+	json body = {{"text", texts}, {"target_lang", upperTarget}, {"source_lang", upperSource}};
+
+	HttpRequest request;
+	request.url = free_ ? "https://api-free.deepl.com/v2/translate"
+			    : "https://api.deepl.com/v2/translate";
+	request.post = true;
+	request.body = body.dump();
+	// DeepL requires specific headers
+	request.headers = {"Content-Type: application/json",
+			   "Authorization: DeepL-Auth-Key " + api_key_};
+
+	HttpResponse response = curl_helper_->perform(request);
+
+	if (response.result != CURLE_OK) {
+		throw TranslationError(std::string("DeepL: CURL request failed: ") +
+				       curl_easy_strerror(response.result));
 	}
 
-	std::string response;
+	// Handle rate limiting errors
+	if (response.status_code == 429) {
+		throw TranslationError("DeepL API Error: Rate limit exceeded", 429);
+	}
+	if (response.status_code == 456) {
+		throw TranslationError("DeepL API Error: Quota exceeded", 456);
+	}
 
 	try {
-		// Construct URL with parameters
-		// Note: DeepL uses uppercase language codes
-		std::string upperTarget = sanitize_language_code(target_lang);
-		std::string upperSource = sanitize_language_code(source_lang);
-		for (char &c : upperTarget)
-			c = (char)std::toupper((int)c);
-		for (char &c : upperSource)
-			c = (char)std::toupper((int)c);
-
-		json body = {{"text", {text}},
-			     {"target_lang", upperTarget},
-			     {"source_lang", upperSource}};
-		const std::string body_str = body.dump();
-
-		std::string url = "https://api.deepl.com/v2/translate";
-		if (free_) {
-			url = "https://api-free.deepl.com/v2/translate";
-		}
-
-		// Set up curl options
-		curl_easy_setopt(curl.get(), CURLOPT_URL, url.c_str());
-		curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, CurlHelper::WriteCallback);
-		curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, &response);
-		curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYPEER, 1L);
-		curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYHOST, 2L);
-		curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT, 30L);
-		curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDS, body_str.c_str());
-		curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDSIZE, body_str.size());
-		curl_easy_setopt(curl.get(), CURLOPT_POST, 1L);
-
-		// DeepL requires specific headers
-		struct curl_slist *headers = nullptr;
-		headers = curl_slist_append(headers, "Content-Type: application/json");
-		headers = curl_slist_append(headers,
-					    ("Authorization: DeepL-Auth-Key " + api_key_).c_str());
-		curl_easy_setopt(curl.get(), CURLOPT_HTTPHEADER, headers);
-
-		CURLcode res = curl_easy_perform(curl.get());
-
-		// Clean up headers
-		curl_slist_free_all(headers);
-
-		if (res != CURLE_OK) {
-			throw TranslationError(std::string("DeepL: CURL request failed: ") +
-					       curl_easy_strerror(res));
-		}
-
-		return parseResponse(response);
-
+		return parseResponse(response.body, texts.size());
 	} catch (const json::exception &e) {
 		throw TranslationError(std::string("DeepL JSON parsing error: ") + e.what() +
-				       ". Response: " + response);
+				       ". Response: " + response.body);
 	}
 }
 
-std::string DeepLTranslator::parseResponse(const std::string &response_str)
+std::vector<std::string> DeepLTranslator::parseResponse(const std::string &response_str,
+							size_t text_count)
 {
-	// Handle rate limiting errors
-	long response_code;
-	curl_easy_getinfo(curl_easy_init(), CURLINFO_RESPONSE_CODE, &response_code);
-	if (response_code == 429) {
-		throw TranslationError("DeepL API Error: Rate limit exceeded");
-	}
-	if (response_code == 456) {
-		throw TranslationError("DeepL API Error: Quota exceeded");
-	}
-
 	/*
     {
         "translations": [
@@ -113,15 +93,24 @@ std::string DeepLTranslator::parseResponse(const std::string &response_str)
 	}
 
 	try {
-		// DeepL returns translations array with detected language
-		const auto &translation = response["translations"][0];
+		// DeepL returns translations array with detected language, one per text
+		const auto &translations = response["translations"];
+		if (translations.size() != text_count) {
+			throw TranslationError("DeepL API Error: expected " +
+					       std::to_string(text_count) + " translations, got " +
+					       std::to_string(translations.size()));
+		}
 
 		// Optionally, you can access the detected source language
 		// if (translation.contains("detected_source_language")) {
 		//     std::string detected = translation["detected_source_language"];
 		// }
 
-		return translation["text"].get<std::string>();
+		std::vector<std::string> results;
+		for (const auto &translation : translations) {
+			results.push_back(translation["text"].get<std::string>());
+		}
+		return results;
 	} catch (const json::exception &) {
 		throw TranslationError("DeepL: Unexpected response format from DeepL API");
 	}
@@ -6,14 +6,23 @@ class CurlHelper; // Forward declaration
 
 class DeepLTranslator : public ITranslator {
 public:
+	static constexpr TranslatorCapabilities capabilities = {"deepl", 50, 128 * 1024, false,
+								false};
+	static std::unique_ptr<ITranslator> create(const CloudTranslatorConfig &config);
+
 	explicit DeepLTranslator(const std::string &api_key, bool free = false);
 	~DeepLTranslator() override;
 
 	std::string translate(const std::string &text, const std::string &target_lang,
 			      const std::string &source_lang = "auto") override;
+	// One request with all texts in the `text` array
+	std::vector<std::string> translateBatch(const std::vector<std::string> &texts,
+						const std::string &target_lang,
+						const std::string &source_lang = "auto") override;
 
 private:
-	std::string parseResponse(const std::string &response_str);
+	std::vector<std::string> parseResponse(const std::string &response_str,
+					       size_t text_count);
 
 	std::string api_key_;
 	bool free_;
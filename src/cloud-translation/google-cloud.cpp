@@ -7,64 +7,59 @@ using json = nlohmann::json;
 
 GoogleTranslator::GoogleTranslator(const std::string &api_key)
 	: api_key_(api_key),
-	  curl_helper_(std::make_unique<CurlHelper>()),
-	  target_lang("en"),
-	  url("")
+	  curl_helper_(std::make_unique<CurlHelper>())
 {
 }
 
 GoogleTranslator::~GoogleTranslator() = default;
 
+std::unique_ptr<ITranslator> GoogleTranslator::create(const CloudTranslatorConfig &config)
+{
+	return std::make_unique<GoogleTranslator>(config.access_key);
+}
+
 std::string GoogleTranslator::translate(const std::string &text, const std::string &target_lang,
 					const std::string &source_lang)
 {
-	std::unique_ptr<CURL, decltype(&curl_easy_cleanup)> curl(curl_easy_init(),
-								 curl_easy_cleanup);
+	return translateBatch({text}, target_lang, source_lang)[0];
+}
 
-	if (!curl) {
-		throw TranslationError("Failed to initialize CURL session");
+std::vector<std::string> GoogleTranslator::translateBatch(const std::vector<std::string> &texts,
+							  const std::string &target_lang,
+							  const std::string &source_lang)
+{
+	// The texts go in a POST body, a batch would not fit in the URL
+	json body = {{"q", texts}, {"target", sanitize_language_code(target_lang)}};
+	if (source_lang != "auto") {
+		body["source"] = sanitize_language_code(source_lang);
 	}
 
-	std::string response;
-
-	try {
-		if (this->url.empty() || this->target_lang != target_lang) {
-			// Construct URL with parameters
-			this->url = "https://translation.googleapis.com/language/translate/v2";
-			this->url += "?key=" + api_key_;
-			this->url += "&q=" + CurlHelper::urlEncode(text);
-			this->url += "&target=" + sanitize_language_code(target_lang);
-
-			if (source_lang != "auto") {
-				this->url += "&source=" + sanitize_language_code(source_lang);
-			}
-
-			this->target_lang = target_lang;
-		}
-
-		// Set up curl options
-		curl_easy_setopt(curl.get(), CURLOPT_URL, url.c_str());
-		curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, CurlHelper::WriteCallback);
-		curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, &response);
-		curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYPEER, 1L);
-		curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYHOST, 2L);
-		curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT, 30L);
+	HttpRequest request;
+	request.url = "https://translation.googleapis.com/language/translate/v2";
+	request.url += "?key=" + api_key_;
+	request.post = true;
+	request.body = body.dump();
+	request.headers = {"Content-Type: application/json"};
 
-		CURLcode res = curl_easy_perform(curl.get());
+	HttpResponse response = curl_helper_->perform(request);
 
-		if (res != CURLE_OK) {
-			throw TranslationError(std::string("CURL request failed: ") +
-					       curl_easy_strerror(res));
-		}
-
-		return parseResponse(response);
+	if (response.result != CURLE_OK) {
+		throw TranslationError(std::string("CURL request failed: ") +
+				       curl_easy_strerror(response.result));
+	}
+	if (response.status_code == 429) {
+		throw TranslationError("HTTP error: 429 Too Many Requests", 429);
+	}
 
+	try {
+		return parseResponse(response.body, texts.size());
 	} catch (const json::exception &e) {
 		throw TranslationError(std::string("JSON parsing error: ") + e.what());
 	}
 }
 
-std::string GoogleTranslator::parseResponse(const std::string &response_str)
+std::vector<std::string> GoogleTranslator::parseResponse(const std::string &response_str,
+							 size_t text_count)
 {
 	json response = json::parse(response_str);
 
@@ -81,5 +76,15 @@ std::string GoogleTranslator::parseResponse(const std::string &response_str)
 		throw TranslationError(error_msg.str());
 	}
 
-	return response["data"]["translations"][0]["translatedText"].get<std::string>();
+	// one translation per `q` entry, in order
+	const auto &translations = response["data"]["translations"];
+	if (translations.size() != text_count) {
+		throw TranslationError("Google API Error: expected " + std::to_string(text_count) +
+				       " translations, got " + std::to_string(translations.size()));
+	}
+	std::vector<std::string> results;
+	for (const auto &translation : translations) {
+		results.push_back(translation["translatedText"].get<std::string>());
+	}
+	return results;
 }
@@ -6,17 +6,23 @@ class CurlHelper; // Forward declaration
 
 class GoogleTranslator : public ITranslator {
 public:
+	static constexpr TranslatorCapabilities capabilities = {"google", 128, 30000, false, false};
+	static std::unique_ptr<ITranslator> create(const CloudTranslatorConfig &config);
+
 	explicit GoogleTranslator(const std::string &api_key);
 	~GoogleTranslator() override;
 
 	std::string translate(const std::string &text, const std::string &target_lang,
 			      const std::string &source_lang = "auto") override;
+	// One request with a `q` entry per text
+	std::vector<std::string> translateBatch(const std::vector<std::string> &texts,
+						const std::string &target_lang,
+						const std::string &source_lang = "auto") override;
 
 private:
-	std::string parseResponse(const std::string &response_str);
+	std::vector<std::string> parseResponse(const std::string &response_str,
+					       size_t text_count);
 
 	std::string api_key_;
 	std::unique_ptr<CurlHelper> curl_helper_;
-	std::string target_lang;
-	std::string url;
 };
@@ -1,5 +1,6 @@
 #include "openai.h"
 #include "utils/curl-helper.h"
+#include "utils/sse-parser.h"
 #include <nlohmann/json.hpp>
 #include <sstream>
 #include <unordered_map>
@@ -18,6 +19,12 @@ OpenAITranslator::OpenAITranslator(const std::string &api_key, const std::string
 
 OpenAITranslator::~OpenAITranslator() = default;
 
+std::unique_ptr<ITranslator> OpenAITranslator::create(const CloudTranslatorConfig &config)
+{
+	return std::make_unique<OpenAITranslator>(
+		config.access_key, config.model.empty() ? "gpt-4-turbo-preview" : config.model);
+}
+
 std::string OpenAITranslator::createSystemPrompt(const std::string &target_lang) const
 {
 	std::string target_language = getLanguageName(target_lang);
@@ -28,8 +35,47 @@ std::string OpenAITranslator::createSystemPrompt(const std::string &target_lang)
 	       "Preserve all formatting, line breaks, and special characters from the original text.";
 }
 
-std::string OpenAITranslator::translate(const std::string &text, const std::string &target_lang,
-					const std::string &source_lang)
+std::string OpenAITranslator::createUserMessage(const std::string &text,
+						const std::string &source_lang) const
+{
+	// Add user message with source language if specified
+	if (source_lang != "auto") {
+		return "Translate the following " + getLanguageName(source_lang) + " text:\n\n" +
+		       text;
+	}
+	return text;
+}
+
+std::string OpenAITranslator::requestPrefix(const std::string &target_lang,
+					    const std::string &source_lang, bool stream)
+{
+	const std::string key = target_lang + '\n' + source_lang + (stream ? "\ns" : "");
+	std::lock_guard<std::mutex> lock(prefixes_mutex_);
+	auto it = prefixes_.find(key);
+	if (it != prefixes_.end()) {
+		return it->second;
+	}
+
+	json head = {{"model", model_},
+		     // Lower temperature for more consistent translations
+		     {"temperature", 0.3},
+		     {"max_tokens", 4000}};
+	if (stream) {
+		head["stream"] = true;
+	}
+	// the messages array is left open after the system message. OpenAI caches long
+	// prompt prefixes by itself, keeping this part byte for byte the same lets it hit.
+	std::string prefix = head.dump();
+	prefix.pop_back();
+	prefix += ",\"messages\":[";
+	prefix += json{{"role", "system"}, {"content", createSystemPrompt(target_lang)}}.dump();
+	prefix += ",";
+	return prefixes_.emplace(key, prefix).first->second;
+}
+
+std::string OpenAITranslator::createRequestBody(const std::string &text,
+						const std::string &target_lang,
+						const std::string &source_lang, bool stream)
 {
 	if (!isLanguageSupported(target_lang)) {
 		throw TranslationError("Unsupported target language: " + target_lang);
@@ -39,85 +85,99 @@ std::string OpenAITranslator::translate(const std::string &text, const std::stri
 		throw TranslationError("Unsupported source language: " + source_lang);
 	}
 
-	std::unique_ptr<CURL, decltype(&curl_easy_cleanup)> curl(curl_easy_init(),
-								 curl_easy_cleanup);
-
-	if (!curl) {
-		throw TranslationError("Failed to initialize CURL session");
+	try {
+		// system message, earlier sentences, then the new one
+		return requestPrefix(target_lang, source_lang, stream) +
+		       context_.messages(target_lang + '\n' + source_lang) +
+		       json{{"role", "user"}, {"content", createUserMessage(text, source_lang)}}
+			       .dump() +
+		       "]}";
+	} catch (const json::exception &e) {
+		throw TranslationError(std::string("JSON parsing error: ") + e.what());
 	}
+}
 
-	std::string response;
+void OpenAITranslator::addContext(const std::string &text, const std::string &translation,
+				  const std::string &target_lang, const std::string &source_lang)
+{
+	// the same user message as in the request, so the request prefix carries over
+	context_.add(target_lang + '\n' + source_lang, createUserMessage(text, source_lang),
+		     translation);
+}
 
-	try {
-		// Prepare the request
-		std::string url = "https://api.openai.com/v1/chat/completions";
+std::string OpenAITranslator::post(const std::string &body,
+				   std::function<void(const char *, size_t)> on_data)
+{
+	HttpRequest request;
+	request.url = "https://api.openai.com/v1/chat/completions";
+	request.post = true;
+	request.body = body;
+	request.headers = {"Content-Type: application/json", "Authorization: Bearer " + api_key_};
+	request.on_data = std::move(on_data);
+
+	HttpResponse response = curl_helper_->perform(request);
+
+	if (response.result != CURLE_OK) {
+		throw TranslationError(std::string("CURL request failed: ") +
+				       curl_easy_strerror(response.result));
+	}
 
-		// Create messages array
-		json messages = json::array();
+	// Check HTTP response code
+	if (response.status_code != 200) {
+		throw TranslationError("HTTP error: " + std::to_string(response.status_code) +
+					       "\nResponse: " + response.body,
+				       response.status_code);
+	}
+	return response.body;
+}
 
-		// Add system message
-		messages.push_back(
-			{{"role", "system"}, {"content", createSystemPrompt(target_lang)}});
+std::string OpenAITranslator::translate(const std::string &text, const std::string &target_lang,
+					const std::string &source_lang)
+{
+	return parseResponse(post(createRequestBody(text, target_lang, source_lang, false)));
+}
 
-		// Add user message with source language if specified
-		std::string user_prompt = text;
-		if (source_lang != "auto") {
-			user_prompt = "Translate the following " + getLanguageName(source_lang) +
-				      " text:\n\n" + text;
+std::string OpenAITranslator::translateStreaming(const std::string &text,
+						 const std::string &target_lang,
+						 const std::string &source_lang,
+						 const TranslationDeltaCallback &on_delta)
+{
+	std::string translation;
+	std::string error;
+	// each event carries a chunk of the completion, the last one is [DONE]
+	SseParser parser([&](const std::string &, const std::string &data) {
+		if (data == "[DONE]") {
+			return;
 		}
-
-		messages.push_back({{"role", "user"}, {"content", user_prompt}});
-
-		// Create request body
-		json request_body = {{"model", model_},
-				     {"messages", messages},
-				     {"temperature",
-				      0.3}, // Lower temperature for more consistent translations
-				     {"max_tokens", 4000}};
-
-		std::string payload = request_body.dump();
-
-		// Set up headers
-		struct curl_slist *headers = nullptr;
-		headers = curl_slist_append(headers, "Content-Type: application/json");
-		headers = curl_slist_append(headers, ("Authorization: Bearer " + api_key_).c_str());
-
-		// Set up CURL request
-		curl_easy_setopt(curl.get(), CURLOPT_URL, url.c_str());
-		curl_easy_setopt(curl.get(), CURLOPT_POST, 1L);
-		curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDS, payload.c_str());
-		curl_easy_setopt(curl.get(), CURLOPT_HTTPHEADER, headers);
-		curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, CurlHelper::WriteCallback);
-		curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, &response);
-		curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYPEER, 1L);
-		curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYHOST, 2L);
-		curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT, 30L);
-
-		// Perform request
-		CURLcode res = curl_easy_perform(curl.get());
-
-		// Clean up
-		curl_slist_free_all(headers);
-
-		if (res != CURLE_OK) {
-			throw TranslationError(std::string("CURL request failed: ") +
-					       curl_easy_strerror(res));
+		json chunk = json::parse(data, nullptr, false);
+		if (chunk.is_discarded() || !chunk.is_object()) {
+			return;
 		}
-
-		// Check HTTP response code
-		long response_code;
-		curl_easy_getinfo(curl.get(), CURLINFO_RESPONSE_CODE, &response_code);
-
-		if (response_code != 200) {
-			throw TranslationError("HTTP error: " + std::to_string(response_code) +
-					       "\nResponse: " + response);
+		if (chunk.contains("error")) {
+			error = chunk["error"].value("message", "Unknown error");
+			return;
 		}
+		if (!chunk.contains("choices") || !chunk["choices"].is_array() ||
+		    chunk["choices"].empty()) {
+			return;
+		}
+		const json &delta = chunk["choices"][0].value("delta", json::object());
+		if (delta.contains("content") && delta["content"].is_string()) {
+			const std::string piece = delta["content"].get<std::string>();
+			translation += piece;
+			if (on_delta && !piece.empty()) {
+				on_delta(piece);
+			}
+		}
+	});
 
-		return parseResponse(response);
+	post(createRequestBody(text, target_lang, source_lang, true),
+	     [&parser](const char *data, size_t size) { parser.feed(data, size); });
 
-	} catch (const json::exception &e) {
-		throw TranslationError(std::string("JSON parsing error: ") + e.what());
+	if (!error.empty()) {
+		throw TranslationError("OpenAI API Error: " + error);
 	}
+	return translation;
 }
 
 std::string OpenAITranslator::parseResponse(const std::string &response_str)
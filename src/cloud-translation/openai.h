@@ -1,23 +1,52 @@
 #pragma once
 #include "ITranslator.h"
+#include "translation-context.h"
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 class CurlHelper; // Forward declaration
 
 class OpenAITranslator : public ITranslator {
 public:
+	static constexpr TranslatorCapabilities capabilities = {"openai", 1, 0, false, true};
+	static std::unique_ptr<ITranslator> create(const CloudTranslatorConfig &config);
+
 	explicit OpenAITranslator(const std::string &api_key,
 				  const std::string &model = "gpt-4-turbo-preview");
 	~OpenAITranslator() override;
 
 	std::string translate(const std::string &text, const std::string &target_lang,
 			      const std::string &source_lang = "auto") override;
+	// Streams the completion as server-sent events
+	std::string translateStreaming(const std::string &text, const std::string &target_lang,
+				       const std::string &source_lang,
+				       const TranslationDeltaCallback &on_delta) override;
+	void addContext(const std::string &text, const std::string &translation,
+			const std::string &target_lang,
+			const std::string &source_lang = "auto") override;
 
 private:
 	std::string parseResponse(const std::string &response_str);
 	std::string createSystemPrompt(const std::string &target_lang) const;
+	std::string createUserMessage(const std::string &text,
+				      const std::string &source_lang) const;
+	// Everything in the request body before the context messages, serialized once per
+	// language pair
+	std::string requestPrefix(const std::string &target_lang, const std::string &source_lang,
+				  bool stream);
+	// Request body for a chat completion, throws TranslationError for unsupported languages
+	std::string createRequestBody(const std::string &text, const std::string &target_lang,
+				      const std::string &source_lang, bool stream);
+	// Sends the request body and returns the response body. on_data, if set, receives the
+	// response as it arrives.
+	std::string post(const std::string &body,
+			 std::function<void(const char *, size_t)> on_data = nullptr);
 
 	std::string api_key_;
 	std::string model_;
 	std::unique_ptr<CurlHelper> curl_helper_;
+	TranslationContext context_;
+	std::mutex prefixes_mutex_;
+	std::unordered_map<std::string, std::string> prefixes_;
 };
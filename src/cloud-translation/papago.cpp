@@ -24,6 +24,11 @@ PapagoTranslator::PapagoTranslator(const std::string &client_id, const std::stri
 
 PapagoTranslator::~PapagoTranslator() = default;
 
+std::unique_ptr<ITranslator> PapagoTranslator::create(const CloudTranslatorConfig &config)
+{
+	return std::make_unique<PapagoTranslator>(config.access_key, config.secret_key);
+}
+
 bool PapagoTranslator::isLanguagePairSupported(const std::string &source,
 					       const std::string &target) const
 {
@@ -119,65 +124,34 @@ std::string PapagoTranslator::translate(const std::string &text, const std::stri
 				       target_lang);
 	}
 
-	std::unique_ptr<CURL, decltype(&curl_easy_cleanup)> curl(curl_easy_init(),
-								 curl_easy_cleanup);
-
-	if (!curl) {
-		throw TranslationError("Failed to initialize CURL session");
-	}
+	try {
+		// Create request body
+		json request_body = {
+			{"source", source_lang}, {"target", target_lang_valid}, {"text", text}};
 
-	std::string response;
+		HttpRequest request;
+		request.url = "https://naveropenapi.apigw.ntruss.com/nmt/v1/translation";
+		request.post = true;
+		request.body = request_body.dump();
+		request.headers = {"Content-Type: application/json",
+				   "X-NCP-APIGW-API-KEY-ID: " + client_id_,
+				   "X-NCP-APIGW-API-KEY: " + client_secret_};
 
-	try {
-		// Prepare request data
-		std::string url = "https://naveropenapi.apigw.ntruss.com/nmt/v1/translation";
+		HttpResponse response = curl_helper_->perform(request);
 
-		// Create request body
-		json request_body = {{"source", source_lang},
-				     {"target", target_lang_valid},
-				     {"text", text}};
-		std::string payload = request_body.dump();
-
-		// Set up headers
-		struct curl_slist *headers = nullptr;
-		headers = curl_slist_append(headers, "Content-Type: application/json");
-		headers = curl_slist_append(headers,
-					    ("X-NCP-APIGW-API-KEY-ID: " + client_id_).c_str());
-		headers = curl_slist_append(headers,
-					    ("X-NCP-APIGW-API-KEY: " + client_secret_).c_str());
-
-		// Set up CURL request
-		curl_easy_setopt(curl.get(), CURLOPT_URL, url.c_str());
-		curl_easy_setopt(curl.get(), CURLOPT_POST, 1L);
-		curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDS, payload.c_str());
-		curl_easy_setopt(curl.get(), CURLOPT_HTTPHEADER, headers);
-		curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, CurlHelper::WriteCallback);
-		curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, &response);
-		curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYPEER, 1L);
-		curl_easy_setopt(curl.get(), CURLOPT_SSL_VERIFYHOST, 2L);
-		curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT, 30L);
-
-		// Perform request
-		CURLcode res = curl_easy_perform(curl.get());
-
-		// Clean up
-		curl_slist_free_all(headers);
-
-		if (res != CURLE_OK) {
+		if (response.result != CURLE_OK) {
 			throw TranslationError(std::string("CURL request failed: ") +
-					       curl_easy_strerror(res));
+					       curl_easy_strerror(response.result));
 		}
 
 		// Check HTTP response code
-		long response_code;
-		curl_easy_getinfo(curl.get(), CURLINFO_RESPONSE_CODE, &response_code);
-
-		if (response_code != 200) {
-			throw TranslationError("HTTP error: " + std::to_string(response_code));
+		if (response.status_code != 200) {
+			throw TranslationError("HTTP error: " +
+						       std::to_string(response.status_code),
+					       response.status_code);
 		}
 
-		return parseResponse(response);
-
+		return parseResponse(response.body);
 	} catch (const json::exception &e) {
 		throw TranslationError(std::string("JSON parsing error: ") + e.what());
 	}
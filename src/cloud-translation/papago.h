@@ -6,6 +6,9 @@ class CurlHelper; // Forward declaration
 
 class PapagoTranslator : public ITranslator {
 public:
+	static constexpr TranslatorCapabilities capabilities = {"papago", 1, 5000, false, false};
+	static std::unique_ptr<ITranslator> create(const CloudTranslatorConfig &config);
+
 	PapagoTranslator(const std::string &client_id, const std::string &client_secret);
 	~PapagoTranslator() override;
 
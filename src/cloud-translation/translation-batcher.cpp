@@ -0,0 +1,134 @@
+#include "translation-batcher.h"
+
+#include <obs-module.h>
+#include "plugin-support.h"
+
+#include "ITranslator.h"
+#include "utils/cancellation.h"
+
+TranslationBatcher &TranslationBatcher::instance()
+{
+	static TranslationBatcher batcher;
+	return batcher;
+}
+
+static bool batch_fits(size_t count, size_t chars, const std::string &text,
+		       const TranslatorCapabilities &capabilities)
+{
+	return count < capabilities.max_batch_size &&
+	       (capabilities.max_request_chars == 0 ||
+		chars + text.size() <= capabilities.max_request_chars);
+}
+
+std::string TranslationBatcher::translate(const std::string &lane_key,
+					  const TranslatorCapabilities &capabilities,
+					  const std::string &text, const std::string &target_lang,
+					  const std::string &source_lang, const Send &send)
+{
+	const std::string key = lane_key + '\n' + target_lang + '\n' + source_lang;
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	Lane &lane = lanes_[key];
+
+	std::shared_ptr<Batch> batch = lane.open;
+	if (batch && !batch->closed &&
+	    batch_fits(batch->texts.size(), batch->chars, text, capabilities)) {
+		// join the batch being gathered, its owner sends it
+		const size_t index = batch->texts.size();
+		batch->texts.push_back(text);
+		batch->chars += text.size();
+		if (!batch_fits(batch->texts.size(), batch->chars, std::string(), capabilities)) {
+			batch->closed = true;
+			lane.open.reset();
+			batch->cv.notify_all();
+		}
+		while (!batch->done) {
+			batch->cv.wait_for(lock, std::chrono::milliseconds(20));
+			if (!batch->done && CancellationScope::cancelled()) {
+				throw TranslationError("Translation cancelled");
+			}
+		}
+		if (!batch->error.empty()) {
+			throw TranslationError(batch->error, batch->error_status);
+		}
+		return batch->results[index];
+	}
+
+	batch = std::make_shared<Batch>();
+	batch->texts.push_back(text);
+	batch->chars = text.size();
+	if (lane.in_flight > 0 && capabilities.max_batch_size > 1) {
+		// a request is already running, more sentences are likely on their way. Hold this
+		// one open for the window, or until it is full.
+		lane.open = batch;
+		const auto start = std::chrono::steady_clock::now();
+		batch->cv.wait_until(lock, start + BATCH_WINDOW,
+				     [&batch] { return batch->closed; });
+		const auto waited = std::chrono::steady_clock::now() - start;
+		metrics_.window_wait_ms +=
+			(uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(waited)
+				.count();
+		batch->closed = true;
+		// the lane may have been rehashed or recreated while waiting
+		Lane &current = lanes_[key];
+		if (current.open == batch) {
+			current.open.reset();
+		}
+	}
+	batch->closed = true;
+	lanes_[key].in_flight++;
+	metrics_.requests++;
+	if (batch->texts.size() > 1) {
+		metrics_.batches++;
+		metrics_.batched_texts += batch->texts.size();
+	}
+	lock.unlock();
+
+	std::vector<std::string> results;
+	std::string error;
+	long error_status = 0;
+	try {
+		if (batch->texts.size() == 1) {
+			results = send(batch->texts);
+		} else {
+			obs_log(LOG_DEBUG, "sending %zu texts in one request. %s -> %s",
+				batch->texts.size(), source_lang.c_str(), target_lang.c_str());
+			// the request serves other callers too, cancelling one must not fail it
+			CancellationScope scope(nullptr);
+			results = send(batch->texts);
+		}
+		if (results.size() != batch->texts.size()) {
+			error = "Expected " + std::to_string(batch->texts.size()) +
+				" translations, got " + std::to_string(results.size());
+		}
+	} catch (const TranslationError &e) {
+		error = e.what();
+		error_status = e.statusCode();
+	} catch (const std::exception &e) {
+		error = std::string("Translation failed: ") + e.what();
+	}
+
+	lock.lock();
+	batch->results = results;
+	batch->error = error;
+	batch->error_status = error_status;
+	batch->done = true;
+	batch->cv.notify_all();
+	Lane &finished = lanes_[key];
+	finished.in_flight--;
+	if (finished.in_flight == 0 && !finished.open) {
+		lanes_.erase(key);
+	}
+	lock.unlock();
+
+	if (!error.empty()) {
+		throw TranslationError(error, error_status);
+	}
+	return results[0];
+}
+
+TranslationBatcher::Metrics TranslationBatcher::metrics()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return metrics_;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "translation-cloud.h"
+
+// Gathers sentences for the same provider settings and language pair into one request, across
+// filters. A sentence arriving while no request for the pair is running is sent right away.
+// During a burst, the first caller holds its request open for BATCH_WINDOW, later callers add
+// their texts to it, and the response is split back to each of them. This keeps the request
+// count, and rate limit errors, down when several filters or sentences finish at once.
+class TranslationBatcher {
+public:
+	struct Metrics {
+		uint64_t requests = 0;       // requests sent, batched or not
+		uint64_t batches = 0;        // requests carrying more than one text
+		uint64_t batched_texts = 0;  // texts sent in those requests
+		uint64_t window_wait_ms = 0; // total time spent holding batches open
+	};
+
+	// Sends one request for texts, returning their translations in order. Throws
+	// TranslationError.
+	typedef std::function<std::vector<std::string>(const std::vector<std::string> &texts)>
+		Send;
+
+	static constexpr std::chrono::milliseconds BATCH_WINDOW{30};
+
+	static TranslationBatcher &instance();
+
+	// Translates text, possibly together with the texts of other callers on the same lane.
+	// The lane identifies the provider and every setting it is sent with, credentials
+	// included, since the caller that ends up sending the batch does so with its send, on
+	// its own thread. Blocks until the translation is done. Throws TranslationError, with
+	// the status code of the failed request.
+	std::string translate(const std::string &lane, const TranslatorCapabilities &capabilities,
+			      const std::string &text, const std::string &target_lang,
+			      const std::string &source_lang, const Send &send);
+
+	Metrics metrics();
+
+private:
+	struct Batch {
+		std::vector<std::string> texts;
+		size_t chars = 0;
+		bool closed = false; // no more texts are added
+		bool done = false;
+		std::vector<std::string> results;
+		std::string error;
+		long error_status = 0; // status code of the failed request
+		std::condition_variable cv;
+	};
+
+	// Requests for one lane and language pair
+	struct Lane {
+		std::shared_ptr<Batch> open; // batch still taking texts
+		size_t in_flight = 0;
+	};
+
+	std::mutex mutex_;
+	std::unordered_map<std::string, Lane> lanes_;
+	Metrics metrics_;
+};
@@ -0,0 +1,103 @@
+#include "translation-cache.h"
+
+#include <cctype>
+
+TranslationCache &TranslationCache::instance()
+{
+	static TranslationCache cache;
+	return cache;
+}
+
+std::string TranslationCache::makeKey(const std::string &provider, const std::string &variant,
+				      const std::string &source_lang,
+				      const std::string &target_lang, const std::string &text)
+{
+	std::string key;
+	key.reserve(provider.size() + variant.size() + source_lang.size() + target_lang.size() +
+		    text.size() + 4);
+	key += provider;
+	key += '\x1f';
+	key += variant;
+	key += '\x1f';
+	key += source_lang;
+	key += '\x1f';
+	key += target_lang;
+	key += '\x1f';
+
+	// trim the text and collapse whitespace runs into a single space
+	bool pending_space = false;
+	const size_t text_start = key.size();
+	for (char c : text) {
+		if (std::isspace((unsigned char)c)) {
+			pending_space = key.size() > text_start;
+			continue;
+		}
+		if (pending_space) {
+			key += ' ';
+			pending_space = false;
+		}
+		key += c;
+	}
+	return key;
+}
+
+bool TranslationCache::get(const std::string &key, std::string &translation)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = index_.find(key);
+	if (it == index_.end()) {
+		metrics_.misses++;
+		return false;
+	}
+	if (it->second->expires_at <= std::chrono::steady_clock::now()) {
+		entries_.erase(it->second);
+		index_.erase(it);
+		metrics_.expired++;
+		metrics_.misses++;
+		return false;
+	}
+	entries_.splice(entries_.begin(), entries_, it->second);
+	translation = it->second->translation;
+	metrics_.hits++;
+	return true;
+}
+
+void TranslationCache::put(const std::string &key, const std::string &translation,
+			   std::chrono::seconds ttl)
+{
+	if (capacity_ == 0) {
+		return;
+	}
+	const auto expires_at = std::chrono::steady_clock::now() + ttl;
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = index_.find(key);
+	if (it != index_.end()) {
+		it->second->translation = translation;
+		it->second->expires_at = expires_at;
+		entries_.splice(entries_.begin(), entries_, it->second);
+		return;
+	}
+	if (entries_.size() >= capacity_) {
+		index_.erase(entries_.back().key);
+		entries_.pop_back();
+		metrics_.evictions++;
+	}
+	entries_.push_front({key, translation, expires_at});
+	index_.emplace(key, entries_.begin());
+}
+
+void TranslationCache::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	entries_.clear();
+	index_.clear();
+}
+
+TranslationCache::Metrics TranslationCache::metrics()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	Metrics metrics = metrics_;
+	metrics.size = entries_.size();
+	return metrics;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Bounded, thread-safe LRU cache of finished translations, shared by all filters. Partials
+// repeat a lot and shows reuse fixed phrases, so a hit saves a full round trip.
+class TranslationCache {
+public:
+	struct Metrics {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t expired = 0; // lookups that found an entry past its TTL
+		uint64_t evictions = 0;
+		size_t size = 0;
+	};
+
+	static constexpr size_t DEFAULT_CAPACITY = 2048;
+	static constexpr std::chrono::seconds DEFAULT_TTL = std::chrono::hours(6);
+
+	explicit TranslationCache(size_t capacity = DEFAULT_CAPACITY) : capacity_(capacity) {}
+
+	static TranslationCache &instance();
+
+	// Builds the lookup key. Texts that differ only in surrounding or repeated whitespace
+	// share a key. variant holds the rest of the settings that change the output, e.g.
+	// the model.
+	static std::string makeKey(const std::string &provider, const std::string &variant,
+				   const std::string &source_lang, const std::string &target_lang,
+				   const std::string &text);
+
+	// Returns true and sets translation on a hit
+	bool get(const std::string &key, std::string &translation);
+	void put(const std::string &key, const std::string &translation,
+		 std::chrono::seconds ttl = DEFAULT_TTL);
+	void clear();
+
+	Metrics metrics();
+
+private:
+	struct Entry {
+		std::string key;
+		std::string translation;
+		std::chrono::steady_clock::time_point expires_at;
+	};
+
+	size_t capacity_;
+	std::mutex mutex_;
+	std::list<Entry> entries_; // most recently used first
+	std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+	Metrics metrics_;
+};
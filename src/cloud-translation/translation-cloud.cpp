@@ -1,9 +1,19 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
 #include <iostream>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
 #include "ITranslator.h"
+#include "circuit-breaker.h"
 #include "google-cloud.h"
 #include "deepl.h"
 #include "azure.h"
@@ -13,48 +23,804 @@
 #include "custom-api.h"
 
 #include "plugin-support.h"
+#include "utils/cancellation.h"
+#include "utils/curl-helper.h"
+#include "utils/rate-limiter.h"
 #include <util/base.h>
 
 #include "translation-cloud.h"
+#include "translation-batcher.h"
+#include "translation-cache.h"
+#include "translation-executor.h"
+#include "translation-latency.h"
+#include "translation-memory.h"
+
+// Translators that can be selected in the settings. Each type provides a static constexpr
+// `capabilities` member and a static create(config) factory.
+template<typename... Translators> struct TranslatorRegistry {
+	static const TranslatorCapabilities *capabilities(const std::string &id)
+	{
+		const TranslatorCapabilities *found = nullptr;
+		((id == Translators::capabilities.id ? (found = &Translators::capabilities, true)
+						     : false) ||
+		 ...);
+		return found;
+	}
+
+	static std::unique_ptr<ITranslator> create(const CloudTranslatorConfig &config)
+	{
+		std::unique_ptr<ITranslator> translator;
+		((config.provider == Translators::capabilities.id
+			  ? (translator = Translators::create(config), true)
+			  : false) ||
+		 ...);
+		return translator;
+	}
+};
+
+// AWS is not listed, its translator is not built yet
+using CloudTranslators = TranslatorRegistry<GoogleTranslator, DeepLTranslator, AzureTranslator,
+					    PapagoTranslator, ClaudeTranslator, OpenAITranslator,
+					    CustomApiTranslator>;
+
+const TranslatorCapabilities *getTranslatorCapabilities(const std::string &provider)
+{
+	return CloudTranslators::capabilities(provider);
+}
 
 std::unique_ptr<ITranslator> createTranslator(const CloudTranslatorConfig &config)
 {
-	if (config.provider == "google") {
-		return std::make_unique<GoogleTranslator>(config.access_key);
-	} else if (config.provider == "deepl") {
-		return std::make_unique<DeepLTranslator>(config.access_key, config.free);
-	} else if (config.provider == "azure") {
-		return std::make_unique<AzureTranslator>(config.access_key, config.region);
-		// } else if (config.provider == "aws") {
-		//     return std::make_unique<AWSTranslator>(config.access_key, config.secret_key, config.region);
-	} else if (config.provider == "papago") {
-		return std::make_unique<PapagoTranslator>(config.access_key, config.secret_key);
-	} else if (config.provider == "claude") {
-		return std::make_unique<ClaudeTranslator>(
-			config.access_key,
-			config.model.empty() ? "claude-3-sonnet-20240229" : config.model);
-	} else if (config.provider == "openai") {
-		return std::make_unique<OpenAITranslator>(
-			config.access_key,
-			config.model.empty() ? "gpt-4-turbo-preview" : config.model);
-	} else if (config.provider == "api") {
-		return std::make_unique<CustomApiTranslator>(config.endpoint, config.body,
-							     config.response_json_path);
-	}
-	throw TranslationError("Unknown translation provider: " + config.provider);
-}
-
-std::string translate_cloud(const CloudTranslatorConfig &config, const std::string &text,
-			    const std::string &target_lang, const std::string &source_lang)
+	std::unique_ptr<ITranslator> translator = CloudTranslators::create(config);
+	if (!translator) {
+		throw TranslationError("Unknown translation provider: " + config.provider);
+	}
+	return translator;
+}
+
+std::shared_ptr<ITranslator> TranslatorCache::get(const CloudTranslatorConfig &config)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	for (const auto &entry : translators_) {
+		if (entry.first == config) {
+			return entry.second;
+		}
+	}
+	std::shared_ptr<ITranslator> translator = createTranslator(config);
+	if (translators_.size() >= MAX_TRANSLATORS) {
+		translators_.erase(translators_.begin());
+	}
+	CloudTranslatorConfig key = config;
+	key.fallbacks.clear();
+	translators_.emplace_back(std::move(key), translator);
+	return translator;
+}
+
+// Bounds of the timeout derived from an endpoint's latency. Until enough requests were
+// timed, the upper bound is used.
+static const long MIN_TIMEOUT_MS = 5000;
+static const long MAX_TIMEOUT_MS = 30000;
+
+// Identifies a provider endpoint for its latency and circuit breaker
+static std::string endpoint_key(const CloudTranslatorConfig &config)
+{
+	return config.provider + '|' + config.region + '|' + config.model + '|' +
+	       config.endpoint + (config.free ? "|free" : "");
+}
+
+static long elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+	return (long)std::chrono::duration_cast<std::chrono::milliseconds>(
+		       std::chrono::steady_clock::now() - start)
+		.count();
+}
+
+// Four times the endpoint's 99th percentile, within the bounds
+static long request_timeout_ms(const std::string &key)
+{
+	const long p99 = (long)LatencyTracker::instance().percentile(key, 0.99).count();
+	return p99 > 0 ? std::clamp(p99 * 4, MIN_TIMEOUT_MS, MAX_TIMEOUT_MS) : MAX_TIMEOUT_MS;
+}
+
+// Sends one request with the given timeout and records how long it took, and for a
+// streamed request how long the first delta took. on_delta may be null.
+static std::string timed_translate(const std::shared_ptr<ITranslator> &translator,
+				   const std::string &key, long timeout_ms, const std::string &text,
+				   const std::string &target_lang, const std::string &source_lang,
+				   const TranslationDeltaCallback &on_delta)
+{
+	LatencyTracker &latency = LatencyTracker::instance();
+	RequestTimeoutScope timeout(timeout_ms);
+	const auto start = std::chrono::steady_clock::now();
+	std::string result;
+	if (on_delta) {
+		bool first = true;
+		result = translator->translateStreaming(
+			text, target_lang, source_lang,
+			[&](const std::string &delta) {
+				if (first) {
+					first = false;
+					const long first_ms = elapsed_ms(start);
+					latency.record(key + "#first",
+						       std::chrono::milliseconds(first_ms));
+				}
+				on_delta(delta);
+			});
+	} else {
+		result = translator->translate(text, target_lang, source_lang);
+	}
+	latency.record(key, std::chrono::milliseconds(elapsed_ms(start)));
+	return result;
+}
+
+// Requests being hedged across all filters. A request over the cap is sent without a duplicate.
+static const int MAX_HEDGED_REQUESTS = 8;
+static std::atomic<int> hedged_requests{0};
+
+// State shared by a request, sent on the caller's thread, and its duplicate, sent by a spare
+// executor task. The duplicate holds its own copy of what it uses, so it may outlive the call.
+struct HedgedRace {
+	std::mutex mutex;
+	std::condition_variable cv;
+	CancellationFlag flags[2] = {make_cancellation_flag(), make_cancellation_flag()};
+	bool duplicate_started = false;
+	bool duplicate_finished = false;
+	bool caller_done = false; // the caller returned, the duplicate must not report progress
+	int winner = -1;
+	int leader = -1; // the streaming attempt whose deltas are shown
+	std::string result;
+	std::exception_ptr errors[2];
+	TranslationProgressCallback on_progress;
+};
+
+// One attempt of a hedged request. Runs in a CancellationScope holding the attempt's flag
+// along with the flags that cancel the request as a whole.
+static void hedged_attempt(const std::shared_ptr<HedgedRace> &race, int index,
+			   const std::shared_ptr<ITranslator> &translator, const std::string &key,
+			   long timeout_ms, const std::string &text, const std::string &target_lang,
+			   const std::string &source_lang)
+{
+	std::string translation;
+	TranslationDeltaCallback on_delta;
+	if (race->on_progress) {
+		on_delta = [&race, &translation, index](const std::string &delta) {
+			std::lock_guard<std::mutex> lock(race->mutex);
+			if (race->leader == -1) {
+				race->leader = index;
+				race->flags[1 - index]->store(true);
+			}
+			if (race->leader != index || race->caller_done) {
+				return;
+			}
+			translation += delta;
+			race->on_progress(translation);
+		};
+	}
+	std::string result;
+	std::exception_ptr error;
+	try {
+		result = timed_translate(translator, key, timeout_ms, text, target_lang,
+					 source_lang, on_delta);
+	} catch (const TranslationError &) {
+		error = std::current_exception();
+	} catch (const std::exception &e) {
+		error = std::make_exception_ptr(
+			TranslationError(std::string("Translation failed: ") + e.what()));
+	}
+	std::lock_guard<std::mutex> lock(race->mutex);
+	race->errors[index] = error;
+	if (!error && race->winner == -1) {
+		race->winner = index;
+		race->result = result;
+		// the caller's transfer aborts within the engine's poll interval
+		race->flags[1 - index]->store(true);
+	}
+	if (index == 1) {
+		race->duplicate_finished = true;
+		race->cv.notify_all();
+	}
+}
+
+// The duplicate of a hedged request, run as a spare executor task once the request took
+// longer than hedge_after_ms. It is not sent when the request is already done or streaming,
+// when the circuit is open or when the rate limit has no token to spare, and its outcome
+// is recorded in the circuit breaker.
+static void send_duplicate(const std::shared_ptr<HedgedRace> &race,
+			   const CancellationFlags &caller_flags,
+			   const std::shared_ptr<ITranslator> &translator, const std::string &key,
+			   const std::string &rate_key, long timeout_ms, const std::string &text,
+			   const std::string &target_lang, const std::string &source_lang)
 {
+	CircuitBreaker &breaker = CircuitBreaker::instance();
+	{
+		std::lock_guard<std::mutex> lock(race->mutex);
+		if (race->caller_done || race->winner != -1 || race->leader != -1 ||
+		    race->errors[0] || any_cancelled(caller_flags)) {
+			return;
+		}
+		if (!breaker.allow(key)) {
+			return;
+		}
+		if (!RateLimiter::instance().acquire(rate_key, REQUEST_PRIORITY_PARTIAL)) {
+			breaker.release(key);
+			return;
+		}
+		// from here on the caller waits for the duplicate if its own request fails
+		race->duplicate_started = true;
+	}
+	LatencyTracker::instance().recordHedged();
+
+	// cancelled by the caller, by the request answering first, or by the workers stopping
+	CancellationFlags flags = CancellationScope::flags();
+	flags.insert(flags.end(), caller_flags.begin(), caller_flags.end());
+	flags.push_back(race->flags[1]);
+	{
+		CancellationScope scope(flags);
+		hedged_attempt(race, 1, translator, key, timeout_ms, text, target_lang,
+			       source_lang);
+	}
+
+	std::exception_ptr error;
+	{
+		std::lock_guard<std::mutex> lock(race->mutex);
+		error = race->errors[1];
+	}
+	if (!error) {
+		breaker.recordSuccess(key);
+		return;
+	}
+	if (any_cancelled(flags)) {
+		breaker.release(key);
+		return;
+	}
 	try {
-		auto translator = createTranslator(config);
-		obs_log(LOG_DEBUG, "translate with cloud provider %s. %s -> %s",
-			config.provider.c_str(), source_lang.c_str(), target_lang.c_str());
-		std::string result = translator->translate(text, target_lang, source_lang);
+		std::rethrow_exception(error);
+	} catch (const TranslationError &e) {
+		breaker.recordFailure(key, e.statusCode() == 429);
+	}
+}
+
+// Translates text, sending a duplicate request if the first one takes longer than 95% of
+// the endpoint's requests did, and returns whichever answers first. For a streamed request
+// the time to the first delta is compared instead, and the first attempt to stream claims
+// the caption. The request is sent on the calling thread, the duplicate on an executor worker
+// that is otherwise idle. The timeout is four times the endpoint's 99th percentile.
+static std::string translate_hedged(const std::shared_ptr<ITranslator> &translator,
+				    const std::string &key, const std::string &rate_key,
+				    const std::string &text, const std::string &target_lang,
+				    const std::string &source_lang,
+				    const TranslationProgressCallback &on_progress)
+{
+	LatencyTracker &latency = LatencyTracker::instance();
+	const long timeout_ms = request_timeout_ms(key);
+	const long hedge_after_ms =
+		(long)latency.percentile(on_progress ? key + "#first" : key, 0.95).count();
+
+	auto translate_directly = [&]() {
+		std::string translation;
+		TranslationDeltaCallback on_delta;
+		if (on_progress) {
+			on_delta = [&translation, &on_progress](const std::string &delta) {
+				translation += delta;
+				on_progress(translation);
+			};
+		}
+		return timed_translate(translator, key, timeout_ms, text, target_lang, source_lang,
+				       on_delta);
+	};
+	// not enough samples to tell a slow request from a normal one
+	if (hedge_after_ms == 0) {
+		return translate_directly();
+	}
+	if (hedged_requests.fetch_add(1) >= MAX_HEDGED_REQUESTS) {
+		hedged_requests--;
+		return translate_directly();
+	}
+	// released with the duplicate's task, which may end after this call
+	struct HedgeSlot {
+		~HedgeSlot() { hedged_requests--; }
+	};
+	auto slot = std::make_shared<HedgeSlot>();
+
+	auto race = std::make_shared<HedgedRace>();
+	race->on_progress = on_progress;
+	const CancellationFlags caller_flags = CancellationScope::flags();
+	const auto start_at = std::chrono::steady_clock::now() +
+			      std::chrono::milliseconds(hedge_after_ms);
+	TranslationExecutor::instance().submitSpare(
+		[race, slot, caller_flags, translator, key, rate_key, timeout_ms, text,
+		 target_lang, source_lang]() {
+			send_duplicate(race, caller_flags, translator, key, rate_key, timeout_ms,
+				       text, target_lang, source_lang);
+		},
+		start_at);
+	slot.reset();
+
+	{
+		CancellationFlags flags = caller_flags;
+		flags.push_back(race->flags[0]);
+		CancellationScope scope(flags);
+		hedged_attempt(race, 0, translator, key, timeout_ms, text, target_lang,
+			       source_lang);
+	}
+
+	std::unique_lock<std::mutex> lock(race->mutex);
+	if (race->winner == -1 && race->duplicate_started) {
+		// the duplicate carries the caller's flags, it ends when the caller is cancelled
+		race->cv.wait(lock, [&race] { return race->duplicate_finished; });
+	}
+	race->caller_done = true;
+	if (race->winner == -1) {
+		// report the failure of an attempt that was not just cancelled by the other one
+		const bool request_superseded = race->flags[0]->load() &&
+						!any_cancelled(caller_flags) && race->errors[1];
+		std::rethrow_exception(race->errors[request_superseded ? 1 : 0]);
+	}
+	if (race->winner == 1) {
+		latency.recordHedgeWin();
+	}
+	return race->result;
+}
+
+// Sends several texts in one request, with a timeout derived from the endpoint's batch
+// requests, which take longer than single ones, and records how long it took
+static std::vector<std::string>
+timed_translate_batch(const std::shared_ptr<ITranslator> &translator, const std::string &key,
+		      const std::vector<std::string> &texts, const std::string &target_lang,
+		      const std::string &source_lang)
+{
+	const std::string batch_key = key + "#batch";
+	RequestTimeoutScope timeout(request_timeout_ms(batch_key));
+	const auto start = std::chrono::steady_clock::now();
+	std::vector<std::string> results = translator->translateBatch(texts, target_lang,
+								      source_lang);
+	LatencyTracker::instance().record(batch_key, std::chrono::milliseconds(elapsed_ms(start)));
+	return results;
+}
+
+// The provider of config followed by its fallbacks
+static std::vector<const CloudTranslatorConfig *>
+provider_chain(const CloudTranslatorConfig &config)
+{
+	std::vector<const CloudTranslatorConfig *> chain = {&config};
+	for (const CloudTranslatorConfig &fallback : config.fallbacks) {
+		chain.push_back(&fallback);
+	}
+	return chain;
+}
+
+// Every setting a request to the provider is sent with, credentials included
+static std::string provider_settings(const CloudTranslatorConfig &provider)
+{
+	return provider.provider + '\n' + provider.access_key + '\n' + provider.secret_key + '\n' +
+	       provider.region + '\n' + provider.endpoint + '\n' + provider.model + '\n' +
+	       provider.body + '\n' + provider.response_json_path +
+	       (provider.free ? "\nfree\n" : "\n");
+}
+
+// Batching translators keep no state of a filter, so one per configuration is shared by all
+// filters, and the sentences of several filters can meet in one batch
+static std::shared_ptr<ITranslator> get_translator(TranslatorCache &cache,
+						   const CloudTranslatorConfig &config)
+{
+	static TranslatorCache shared;
+	const TranslatorCapabilities *capabilities = getTranslatorCapabilities(config.provider);
+	return (capabilities && capabilities->max_batch_size > 1 ? shared : cache).get(config);
+}
+
+static std::string rate_key(const CloudTranslatorConfig &config)
+{
+	return RateLimiter::makeKey(config.provider, config.access_key);
+}
+
+void set_translation_rate_limit(const void *owner, const CloudTranslatorConfig &config,
+				double per_second)
+{
+	std::vector<std::string> keys;
+	for (const CloudTranslatorConfig *provider : provider_chain(config)) {
+		keys.push_back(rate_key(*provider));
+	}
+	RateLimiter::instance().setRate(owner, keys, per_second);
+}
+
+// A translation, and the provider of the chain that made it
+struct ChainTranslation {
+	std::string translation; // empty if every provider failed
+	size_t provider = 0;     // index in provider_chain
+};
+
+// Sends the request to the first provider of the chain, from first_provider on, whose circuit
+// breaker is closed and whose rate limit lets it through, moving on to the next one when it
+// fails. The translation is empty if all of them failed or the request was cancelled.
+// on_progress receives the translation so far if the provider streams it.
+static ChainTranslation
+request_translation(TranslatorCache &cache, const CloudTranslatorConfig &config,
+		    const std::string &text, const std::string &target_lang,
+		    const std::string &source_lang, RequestPriority priority,
+		    const TranslationProgressCallback &on_progress = nullptr,
+		    size_t first_provider = 0)
+{
+	CircuitBreaker &breaker = CircuitBreaker::instance();
+	const std::vector<const CloudTranslatorConfig *> chain = provider_chain(config);
+	for (size_t i = first_provider; i < chain.size(); i++) {
+		const CloudTranslatorConfig &provider = *chain[i];
+		const std::string key = endpoint_key(provider);
+		// checked before the rate limit, a provider that is skipped must not spend tokens
+		// or keep a final waiting for one
+		if (!breaker.allow(key)) {
+			obs_log(LOG_DEBUG, "skipping cloud provider %s, its circuit is open",
+				provider.provider.c_str());
+			continue;
+		}
+		// a request the provider has no room for may still fit the next one
+		if (!RateLimiter::instance().acquire(rate_key(provider), priority)) {
+			breaker.release(key);
+			if (CancellationScope::cancelled()) {
+				return {};
+			}
+			continue;
+		}
+		try {
+			std::shared_ptr<ITranslator> translator = get_translator(cache, provider);
+			obs_log(LOG_DEBUG, "translate with cloud provider %s. %s -> %s",
+				provider.provider.c_str(), source_lang.c_str(),
+				target_lang.c_str());
+			const TranslatorCapabilities *capabilities =
+				getTranslatorCapabilities(provider.provider);
+			const std::string limiter_key = rate_key(provider);
+			std::string result;
+			if (capabilities && capabilities->max_batch_size > 1) {
+				// sentences arriving together share a request, one sent on its own
+				// is hedged like any other
+				auto send = [&](const std::vector<std::string> &texts) {
+					if (texts.size() > 1) {
+						return timed_translate_batch(translator, key, texts,
+									     target_lang,
+									     source_lang);
+					}
+					return std::vector<std::string>{translate_hedged(
+						translator, key, limiter_key, texts[0], target_lang,
+						source_lang, nullptr)};
+				};
+				// sentences of filters sending with the same settings share a lane
+				const std::string lane =
+					provider.provider + '\n' +
+					std::to_string(std::hash<std::string>()(
+						provider_settings(provider)));
+				result = TranslationBatcher::instance().translate(
+					lane, *capabilities, text, target_lang, source_lang, send);
+			} else {
+				const bool streaming =
+					on_progress && capabilities && capabilities->streaming;
+				result = translate_hedged(translator, key, limiter_key, text,
+							  target_lang, source_lang,
+							  streaming ? on_progress : nullptr);
+			}
+			breaker.recordSuccess(key);
+			return {result, i};
+		} catch (const TranslationError &e) {
+			if (CancellationScope::cancelled()) {
+				breaker.release(key);
+				obs_log(LOG_DEBUG, "Translation cancelled");
+				return {};
+			}
+			breaker.recordFailure(key, e.statusCode() == 429);
+			obs_log(LOG_ERROR, "Translation error: %s\n", e.what());
+		}
+	}
+	return {};
+}
+
+// Outcome of a shared request
+struct FlightResult {
+	ChainTranslation result;
+	bool abandoned; // the caller sending it was cancelled before it finished
+};
+
+// Requests in flight by flight key. Filters translating the same text into the same language
+// at the same time, with the same providers and credentials, share one request.
+static std::mutex flights_mutex;
+static std::unordered_map<std::string, std::shared_future<FlightResult>> flights;
+
+// The primary provider's cache key, plus a hash of everything that decides how the request is
+// sent. A request failing for one configuration, e.g. with a bad key or an open circuit, must
+// not fail it for a caller whose configuration works.
+static std::string flight_key(const CloudTranslatorConfig &config, const std::string &cache_key)
+{
+	std::string chain;
+	for (const CloudTranslatorConfig *provider : provider_chain(config)) {
+		chain += provider_settings(*provider);
+	}
+	return cache_key + '\n' + std::to_string(std::hash<std::string>()(chain));
+}
+
+// Sends the request unless an identical one is already in flight, in which case its result
+// is shared. Only the caller sending the request gets progress. When that caller is cancelled
+// before the request finished, one of the callers still waiting sends it instead.
+static ChainTranslation
+request_translation_once(TranslatorCache &cache, const CloudTranslatorConfig &config,
+			 const std::string &cache_key, const std::string &text,
+			 const std::string &target_lang, const std::string &source_lang,
+			 RequestPriority priority,
+			 const TranslationProgressCallback &on_progress = nullptr)
+{
+	const std::string key = flight_key(config, cache_key);
+	for (;;) {
+		std::promise<FlightResult> promise;
+		std::shared_future<FlightResult> flight;
+		{
+			std::lock_guard<std::mutex> lock(flights_mutex);
+			auto it = flights.find(key);
+			if (it == flights.end()) {
+				flights.emplace(key, promise.get_future().share());
+			} else {
+				flight = it->second;
+			}
+		}
+
+		if (!flight.valid()) {
+			ChainTranslation result;
+			try {
+				result = request_translation(cache, config, text, target_lang,
+							     source_lang, priority, on_progress);
+			} catch (...) {
+				result = ChainTranslation();
+			}
+			{
+				std::lock_guard<std::mutex> lock(flights_mutex);
+				flights.erase(key);
+			}
+			const bool abandoned =
+				result.translation.empty() && CancellationScope::cancelled();
+			promise.set_value({result, abandoned});
+			return result;
+		}
+
+		obs_log(LOG_DEBUG, "joining a translation already in flight. %s -> %s",
+			source_lang.c_str(), target_lang.c_str());
+		while (flight.wait_for(std::chrono::milliseconds(20)) !=
+		       std::future_status::ready) {
+			if (CancellationScope::cancelled()) {
+				return {};
+			}
+		}
+		const FlightResult &result = flight.get();
+		if (!result.abandoned) {
+			return result.result;
+		}
+		// the caller sending it gave up, which does not apply here: take over
+	}
+}
+
+// Sends one request for all of target_langs to the provider of config, without its fallbacks.
+// Returns empty strings if it failed, was cancelled or the circuit breaker is open.
+static std::vector<std::string>
+request_translation_multi(TranslatorCache &cache, const CloudTranslatorConfig &config,
+			  const std::string &text, const std::vector<std::string> &target_langs,
+			  const std::string &source_lang, RequestPriority priority)
+{
+	CircuitBreaker &breaker = CircuitBreaker::instance();
+	const std::string key = endpoint_key(config);
+	if (!breaker.allow(key)) {
+		return std::vector<std::string>(target_langs.size());
+	}
+	if (!RateLimiter::instance().acquire(rate_key(config), priority)) {
+		breaker.release(key);
+		return std::vector<std::string>(target_langs.size());
+	}
+	try {
+		std::shared_ptr<ITranslator> translator = get_translator(cache, config);
+		obs_log(LOG_DEBUG, "translate with cloud provider %s. %s -> %zu languages",
+			config.provider.c_str(), source_lang.c_str(), target_langs.size());
+		std::vector<std::string> results =
+			translator->translateMulti(text, target_langs, source_lang);
+		if (results.size() == target_langs.size()) {
+			breaker.recordSuccess(key);
+			return results;
+		}
+		breaker.recordFailure(key, false);
+		obs_log(LOG_ERROR, "Translation error: expected %zu translations, got %zu",
+			target_langs.size(), results.size());
+	} catch (const TranslationError &e) {
+		if (CancellationScope::cancelled()) {
+			breaker.release(key);
+			obs_log(LOG_DEBUG, "Translation cancelled");
+		} else {
+			breaker.recordFailure(key, e.statusCode() == 429);
+			obs_log(LOG_ERROR, "Translation error: %s\n", e.what());
+		}
+	}
+	return std::vector<std::string>(target_langs.size());
+}
+
+// Keyed by every setting of the provider that changes its output, not by its credentials
+static std::string make_cache_key(const CloudTranslatorConfig &config, const std::string &text,
+				  const std::string &target_lang, const std::string &source_lang)
+{
+	const std::string variant = config.region + '\x1f' + config.model + '\x1f' +
+				    config.endpoint + '\x1f' + (config.free ? "free" : "pro") +
+				    '\x1f' + config.body + '\x1f' + config.response_json_path;
+	return TranslationCache::makeKey(config.provider, variant, source_lang, target_lang, text);
+}
+
+// Looks the translation up in the cache, then in the translation memory
+static bool lookup_translation(const std::string &cache_key, TranslationMemoryUse memory_use,
+			       const std::string &target_lang, const std::string &source_lang,
+			       std::string &result)
+{
+	if (TranslationCache::instance().get(cache_key, result)) {
+		obs_log(LOG_DEBUG, "translation cache hit. %s -> %s", source_lang.c_str(),
+			target_lang.c_str());
+		return true;
+	}
+	if (memory_use != TRANSLATION_MEMORY_OFF &&
+	    TranslationMemory::instance().get(cache_key, result)) {
+		obs_log(LOG_DEBUG, "translation memory hit. %s -> %s", source_lang.c_str(),
+			target_lang.c_str());
+		TranslationCache::instance().put(cache_key, result);
+		return true;
+	}
+	return false;
+}
+
+// Stored under the key of the provider that made the translation. A fallback's translation is
+// not what the primary provider would have returned, and must not be served as its result.
+static void store_translation(const CloudTranslatorConfig &config,
+			      const ChainTranslation &translated, const std::string &text,
+			      const std::string &target_lang, const std::string &source_lang,
+			      TranslationMemoryUse memory_use)
+{
+	if (translated.translation.empty()) {
+		return;
+	}
+	const std::string cache_key = make_cache_key(*provider_chain(config)[translated.provider],
+						     text, target_lang, source_lang);
+	TranslationCache::instance().put(cache_key, translated.translation);
+	if (memory_use == TRANSLATION_MEMORY_READ_WRITE) {
+		TranslationMemory::instance().put(cache_key, translated.translation);
+	}
+}
+
+std::string translate_cloud(TranslatorCache &cache, const CloudTranslatorConfig &config,
+			    const std::string &text, const std::string &target_lang,
+			    const std::string &source_lang, TranslationMemoryUse memory_use)
+{
+	const std::string cache_key = make_cache_key(config, text, target_lang, source_lang);
+	std::string result;
+	if (lookup_translation(cache_key, memory_use, target_lang, source_lang, result)) {
 		return result;
+	}
+
+	const ChainTranslation translated = request_translation_once(
+		cache, config, cache_key, text, target_lang, source_lang, REQUEST_PRIORITY_FINAL);
+	store_translation(config, translated, text, target_lang, source_lang, memory_use);
+	return translated.translation;
+}
+
+void remember_translation(TranslatorCache &cache, const CloudTranslatorConfig &config,
+			  const std::string &text, const std::string &translation,
+			  const std::string &target_lang, const std::string &source_lang)
+{
+	try {
+		get_translator(cache, config)
+			->addContext(text, translation, target_lang, source_lang);
 	} catch (const TranslationError &e) {
 		obs_log(LOG_ERROR, "Translation error: %s\n", e.what());
 	}
-	return "";
+}
+
+// The languages of a multi-language translation sent one request each. Each is taken once,
+// either by the calling thread or by a spare executor task.
+struct LanguageShare {
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::vector<bool> taken;
+	std::vector<ChainTranslation> translated;
+	size_t running = 0; // languages taken and not translated yet
+
+	bool take(size_t j)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (taken[j]) {
+			return false;
+		}
+		taken[j] = true;
+		running++;
+		return true;
+	}
+
+	void finish(size_t j, const ChainTranslation &result)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		translated[j] = result;
+		running--;
+		cv.notify_all();
+	}
+};
+
+std::vector<std::string>
+translate_cloud_multi(TranslatorCache &cache, const CloudTranslatorConfig &config,
+		      const std::string &text, const std::vector<std::string> &target_langs,
+		      const std::string &source_lang, TranslationMemoryUse memory_use,
+		      const TranslationProgressCallback &on_progress, RequestPriority priority)
+{
+	std::vector<std::string> results(target_langs.size());
+	std::vector<std::string> cache_keys(target_langs.size());
+	std::vector<size_t> missing;
+	for (size_t i = 0; i < target_langs.size(); i++) {
+		cache_keys[i] = make_cache_key(config, text, target_langs[i], source_lang);
+		if (!lookup_translation(cache_keys[i], memory_use, target_langs[i], source_lang,
+					results[i])) {
+			missing.push_back(i);
+		}
+	}
+	if (missing.empty()) {
+		return results;
+	}
+
+	std::vector<ChainTranslation> translated(target_langs.size());
+	const TranslatorCapabilities *capabilities = getTranslatorCapabilities(config.provider);
+	if (missing.size() > 1 && capabilities && capabilities->multi_target) {
+		std::vector<std::string> missing_langs;
+		for (size_t i : missing) {
+			missing_langs.push_back(target_langs[i]);
+		}
+		const std::vector<std::string> multi = request_translation_multi(
+			cache, config, text, missing_langs, source_lang, priority);
+		for (size_t j = 0; j < missing.size(); j++) {
+			translated[missing[j]].translation = multi[j];
+			// the provider failed, go down the rest of the chain one language at a time
+			if (multi[j].empty() && !config.fallbacks.empty() &&
+			    !CancellationScope::cancelled()) {
+				translated[missing[j]] = request_translation(
+					cache, config, text, target_langs[missing[j]], source_lang,
+					priority, nullptr, 1);
+			}
+		}
+	} else {
+		// one request per language. This thread goes through them in order while idle
+		// workers take the ones it has not started, carrying its cancellation flags.
+		auto share = std::make_shared<LanguageShare>();
+		share->taken.assign(missing.size(), false);
+		share->translated.resize(missing.size());
+		const CancellationFlags caller_flags = CancellationScope::flags();
+		auto translate_language = [&](size_t j) {
+			const size_t i = missing[j];
+			return request_translation_once(cache, config, cache_keys[i], text,
+							target_langs[i], source_lang, priority,
+							i == 0 ? on_progress : nullptr);
+		};
+		for (size_t j = 1; j < missing.size(); j++) {
+			// the references are only used by a task that took its language, which
+			// this thread waits for
+			TranslationExecutor::instance().submitSpare(
+				[share, j, caller_flags, &translate_language]() {
+					if (!share->take(j)) {
+						return;
+					}
+					CancellationFlags flags = CancellationScope::flags();
+					flags.insert(flags.end(), caller_flags.begin(),
+						     caller_flags.end());
+					CancellationScope scope(flags);
+					share->finish(j, translate_language(j));
+				},
+				std::chrono::steady_clock::now());
+		}
+		for (size_t j = 0; j < missing.size(); j++) {
+			if (share->take(j)) {
+				share->finish(j, translate_language(j));
+			}
+		}
+		std::unique_lock<std::mutex> lock(share->mutex);
+		share->cv.wait(lock, [&share] { return share->running == 0; });
+		for (size_t j = 0; j < missing.size(); j++) {
+			translated[missing[j]] = share->translated[j];
+		}
+	}
+
+	for (size_t i : missing) {
+		results[i] = translated[i].translation;
+		store_translation(config, translated[i], text, target_langs[i], source_lang,
+				  memory_use);
+	}
+	return results;
 }
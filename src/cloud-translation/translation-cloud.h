@@ -1,6 +1,16 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "utils/rate-limiter.h"
+
+class ITranslator;
 
 struct CloudTranslatorConfig {
 	std::string provider;
@@ -12,7 +22,88 @@ struct CloudTranslatorConfig {
 	std::string endpoint;           // For Custom API
 	std::string body;               // For Custom API
 	std::string response_json_path; // For Custom API
+	// Providers tried in order when this one fails or its circuit breaker is open. Not
+	// compared, they do not change the translator made from this config.
+	std::vector<CloudTranslatorConfig> fallbacks;
+
+	bool operator==(const CloudTranslatorConfig &other) const
+	{
+		return provider == other.provider && access_key == other.access_key &&
+		       secret_key == other.secret_key && region == other.region &&
+		       model == other.model && free == other.free && endpoint == other.endpoint &&
+		       body == other.body && response_json_path == other.response_json_path;
+	}
+	bool operator!=(const CloudTranslatorConfig &other) const { return !(*this == other); }
+};
+
+// What a translation API supports. Each translator declares these as a static constexpr
+// `capabilities` member next to its static create(config) factory.
+struct TranslatorCapabilities {
+	const char *id;           // value of the translate_cloud_provider setting
+	size_t max_batch_size;    // texts accepted in a single request, 1 if it takes only one
+	size_t max_request_chars; // request size limit, 0 if there is no documented limit
+	bool multi_target;        // can translate into several languages in one request
+	bool streaming;           // can stream the translation as it is generated
+};
+
+// Returns nullptr for an unknown provider id
+const TranslatorCapabilities *getTranslatorCapabilities(const std::string &provider);
+
+// Keeps the translators for the current settings, the selected provider and its fallbacks,
+// alive between sentences so they are not rebuilt (and their connections re-established) for
+// every request. The least recently created translator is dropped once there are more than
+// MAX_TRANSLATORS; requests still running on it keep it alive until they finish.
+class TranslatorCache {
+public:
+	static constexpr size_t MAX_TRANSLATORS = 8;
+
+	// Throws TranslationError for an unknown provider
+	std::shared_ptr<ITranslator> get(const CloudTranslatorConfig &config);
+
+private:
+	std::mutex mutex_;
+	std::vector<std::pair<CloudTranslatorConfig, std::shared_ptr<ITranslator>>> translators_;
+};
+
+// How translate_cloud uses the translation memory kept on disk across sessions
+enum TranslationMemoryUse {
+	TRANSLATION_MEMORY_OFF = 0,
+	TRANSLATION_MEMORY_READ = 1,       // look translations up, e.g. for partials
+	TRANSLATION_MEMORY_READ_WRITE = 2, // also remember new translations
 };
 
-std::string translate_cloud(const CloudTranslatorConfig &config, const std::string &text,
-			    const std::string &target_lang, const std::string &source_lang);
+std::string translate_cloud(TranslatorCache &cache, const CloudTranslatorConfig &config,
+			    const std::string &text, const std::string &target_lang,
+			    const std::string &source_lang,
+			    TranslationMemoryUse memory_use = TRANSLATION_MEMORY_OFF);
+
+// Tells the translator for config that text was translated as translation, so LLM
+// translators can pass it as context with the sentences that follow. Call it for finished
+// sentences only, not for partials.
+void remember_translation(TranslatorCache &cache, const CloudTranslatorConfig &config,
+			  const std::string &text, const std::string &translation,
+			  const std::string &target_lang, const std::string &source_lang);
+
+// Receives the translation so far while a streaming provider generates it
+typedef std::function<void(const std::string &translation)> TranslationProgressCallback;
+
+// Translates text into each of target_langs, returning the translations in the same order.
+// Languages missing from the caches are requested together when the provider can translate
+// into several languages at once, otherwise one request per language, sent concurrently by
+// the translation workers that are idle. A failed translation is an empty string.
+// on_progress follows the first language while it is streamed, it is not called when the
+// translation comes from a cache or the provider does not stream. Partials are the first
+// requests dropped when a provider's rate limit is reached.
+std::vector<std::string>
+translate_cloud_multi(TranslatorCache &cache, const CloudTranslatorConfig &config,
+		      const std::string &text, const std::vector<std::string> &target_langs,
+		      const std::string &source_lang,
+		      TranslationMemoryUse memory_use = TRANSLATION_MEMORY_OFF,
+		      const TranslationProgressCallback &on_progress = nullptr,
+		      RequestPriority priority = REQUEST_PRIORITY_FINAL);
+
+// Limits the requests to the provider of config and to each of its fallbacks, per provider
+// and API key, in requests per second. 0 removes the limit owner set. Where several owners
+// limit the same provider and key, the lowest rate applies.
+void set_translation_rate_limit(const void *owner, const CloudTranslatorConfig &config,
+				double per_second);
@@ -0,0 +1,45 @@
+#include "translation-context.h"
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+void TranslationContext::add(const std::string &key, const std::string &user_message,
+			     const std::string &translation)
+{
+	Turn turn;
+	turn.serialized = json{{"role", "user"}, {"content", user_message}}.dump() + "," +
+			  json{{"role", "assistant"}, {"content", translation}}.dump() + ",";
+	turn.tokens = estimateTokens(user_message) + estimateTokens(translation);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	Window &window = windows_[key];
+	window.turns.push_back(turn);
+	window.serialized += turn.serialized;
+	window.tokens += turn.tokens;
+	if (window.tokens <= token_budget_) {
+		return;
+	}
+
+	// drop the older half in one go, the prefix then stays the same for a while
+	while (window.turns.size() > 1 && window.tokens > token_budget_ / 2) {
+		window.tokens -= window.turns.front().tokens;
+		window.turns.pop_front();
+	}
+	if (window.tokens > token_budget_) {
+		// a single sentence over the budget
+		window.turns.clear();
+		window.tokens = 0;
+	}
+	window.serialized.clear();
+	for (const Turn &kept : window.turns) {
+		window.serialized += kept.serialized;
+	}
+}
+
+std::string TranslationContext::messages(const std::string &key)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = windows_.find(key);
+	return it == windows_.end() ? std::string() : it->second.serialized;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Recent sentences and their translations, sent to LLM translators as earlier turns of the
+// conversation so names and terms come out the same way from one sentence to the next.
+// There is a window per language pair, kept within a token budget. A window only grows
+// until it is over budget, then its older half is dropped at once, so consecutive requests
+// share as long a prefix as possible for provider-side prompt caching. The turns are kept
+// serialized, they are not re-encoded for every request.
+class TranslationContext {
+public:
+	static constexpr size_t DEFAULT_TOKEN_BUDGET = 1500;
+
+	explicit TranslationContext(size_t token_budget = DEFAULT_TOKEN_BUDGET)
+		: token_budget_(token_budget)
+	{
+	}
+
+	// Adds a turn: the user message that was sent and the translation that came back
+	void add(const std::string &key, const std::string &user_message,
+		 const std::string &translation);
+
+	// The turns of the window as JSON chat messages ({"role": ..., "content": ...}), each
+	// followed by a comma, ready to go in front of the new message
+	std::string messages(const std::string &key);
+
+	// Rough token count, about four bytes per token. Good enough for a budget.
+	static size_t estimateTokens(const std::string &text) { return text.size() / 4 + 4; }
+
+private:
+	struct Turn {
+		std::string serialized; // user and assistant message, each followed by a comma
+		size_t tokens;
+	};
+	struct Window {
+		std::deque<Turn> turns;
+		std::string serialized;
+		size_t tokens = 0;
+	};
+
+	std::mutex mutex_;
+	std::unordered_map<std::string, Window> windows_;
+	size_t token_budget_;
+};
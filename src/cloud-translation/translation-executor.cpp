@@ -0,0 +1,392 @@
+#include "translation-executor.h"
+
+#include <algorithm>
+#include <exception>
+
+#include "plugin-support.h"
+#include <util/base.h>
+
+// Concurrent requests across all filters. Translation requests are mostly waiting on the
+// network, this bounds the number of connections rather than CPU use.
+static const size_t WORKER_COUNT = 4;
+// Final sentences a group may have queued before it is backlogged. Finals past this are
+// still queued, the caller is the transcription results thread and must not wait, and the
+// group's partials are skipped instead. Partials do not count, only the newest one is kept.
+static const size_t MAX_PENDING_PER_GROUP = 4;
+// Tasks a group may have running at once, so one filter cannot occupy every worker
+static const size_t MAX_RUNNING_PER_GROUP = 2;
+// Tasks queued across all groups before every group submitting is backlogged
+static const size_t MAX_QUEUED = 32;
+
+static uint64_t elapsed_ms(std::chrono::steady_clock::time_point since)
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+		       std::chrono::steady_clock::now() - since)
+		.count();
+}
+
+TranslationExecutor &TranslationExecutor::instance()
+{
+	static TranslationExecutor executor;
+	return executor;
+}
+
+TranslationExecutor::Metrics TranslationExecutor::metrics()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return metrics_;
+}
+
+std::shared_ptr<TranslationExecutor::GroupState>
+TranslationExecutor::openGroup(const std::string &name)
+{
+	std::lock_guard<std::mutex> lifecycle_lock(lifecycle_mutex_);
+	auto group = std::make_shared<GroupState>();
+	group->name = name;
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	groups_.push_back(group);
+	if (workers_.empty()) {
+		obs_log(LOG_INFO, "Starting %zu translation workers", WORKER_COUNT);
+		for (size_t i = 0; i < WORKER_COUNT; i++) {
+			workers_.emplace_back(&TranslationExecutor::workerLoop, this);
+		}
+	}
+	return group;
+}
+
+bool TranslationExecutor::submit(GroupState &group, Task task)
+{
+	// a partial that is superseded is destroyed after the lock is released, destroying what
+	// it captured may run code of its own
+	QueuedTask superseded;
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (group.closed) {
+		return false;
+	}
+	metrics_.submitted++;
+	group.metrics.submitted++;
+	// the final sentence replaces whatever partial of it is shown
+	superseded = supersedePartials(group);
+	if (overLimit(group)) {
+		metrics_.backlogged++;
+		group.metrics.backlogged++;
+		if (!group.backlogged) {
+			group.backlogged = true;
+			obs_log(LOG_WARNING,
+				"Translation queue of '%s' is backlogged, partials are skipped "
+				"until it catches up",
+				group.name.c_str());
+		}
+	}
+	group.pending.push_back({std::move(task), std::chrono::steady_clock::now(),
+				 make_cancellation_flag(), false});
+	metrics_.queued++;
+	metrics_.peak_queued = std::max(metrics_.peak_queued, metrics_.queued);
+	work_cv_.notify_one();
+	return true;
+}
+
+void TranslationExecutor::submitPartial(GroupState &group, Task task)
+{
+	QueuedTask superseded;
+	std::lock_guard<std::mutex> lock(mutex_);
+	metrics_.submitted++;
+	group.metrics.submitted++;
+	if (!group.pending.empty() && overLimit(group)) {
+		// the finals ahead of it would supersede it before it runs
+		metrics_.shed++;
+		group.metrics.shed++;
+		superseded.task = std::move(task);
+		return;
+	}
+	if (group.partial.task) {
+		metrics_.superseded++;
+		group.metrics.superseded++;
+	} else {
+		metrics_.queued++;
+		metrics_.peak_queued = std::max(metrics_.peak_queued, metrics_.queued);
+	}
+	superseded = std::move(group.partial);
+	group.partial = {std::move(task), std::chrono::steady_clock::now(),
+			 make_cancellation_flag(), true};
+	// the running partial translates outdated text, its result must not reach the caption
+	if (group.running_partial && !group.running_partial->exchange(true)) {
+		metrics_.superseded++;
+		group.metrics.superseded++;
+	}
+	work_cv_.notify_one();
+}
+
+bool TranslationExecutor::submitSpare(Task task, std::chrono::steady_clock::time_point start_at)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (workers_.empty() || stopping_) {
+		return false;
+	}
+	spare_.push_back({std::move(task), start_at, make_cancellation_flag(), false});
+	work_cv_.notify_one();
+	return true;
+}
+
+void TranslationExecutor::setMinPartialInterval(GroupState &group,
+						std::chrono::milliseconds interval)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	group.min_partial_interval = interval;
+	work_cv_.notify_one();
+}
+
+TranslationExecutor::QueuedTask TranslationExecutor::supersedePartials(GroupState &group)
+{
+	QueuedTask superseded;
+	if (group.partial.task) {
+		superseded = std::move(group.partial);
+		group.partial = QueuedTask();
+		metrics_.queued--;
+		metrics_.superseded++;
+		group.metrics.superseded++;
+	}
+	if (group.running_partial && !group.running_partial->exchange(true)) {
+		metrics_.superseded++;
+		group.metrics.superseded++;
+	}
+	return superseded;
+}
+
+bool TranslationExecutor::overLimit(const GroupState &group) const
+{
+	return group.pending.size() >= MAX_PENDING_PER_GROUP || metrics_.queued >= MAX_QUEUED;
+}
+
+void TranslationExecutor::closeGroup(const std::shared_ptr<GroupState> &group)
+{
+	std::lock_guard<std::mutex> lifecycle_lock(lifecycle_mutex_);
+	std::vector<std::thread> workers;
+	std::deque<QueuedTask> cancelled_tasks;
+	QueuedTask cancelled_partial;
+	std::vector<QueuedTask> cancelled_spare;
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		group->closed = true;
+		const size_t cancelled = group->pending.size() + (group->partial.task ? 1 : 0);
+		cancelled_tasks.swap(group->pending);
+		cancelled_partial = std::move(group->partial);
+		group->partial = QueuedTask();
+		metrics_.queued -= cancelled;
+		metrics_.cancelled += cancelled;
+		group->metrics.cancelled += cancelled;
+		groups_.erase(std::remove(groups_.begin(), groups_.end(), group), groups_.end());
+
+		// abort the requests in flight, then wait for the tasks: they may still use the
+		// filter's data
+		for (const CancellationFlag &flag : group->running) {
+			flag->store(true);
+		}
+		idle_cv_.wait(lock, [&group] { return group->running.empty(); });
+
+		const Metrics &m = group->metrics;
+		obs_log(LOG_INFO,
+			"Translation group '%s' closed: %llu submitted, %llu completed, "
+			"%llu failed, %llu backlogged, %llu shed, %llu superseded, "
+			"%llu cancelled, %llu ms average queue wait",
+			group->name.c_str(), m.submitted, m.completed, m.failed, m.backlogged,
+			m.shed, m.superseded, m.cancelled,
+			m.completed + m.failed > 0 ? m.queue_wait_ms / (m.completed + m.failed)
+						   : 0);
+
+		// stop the workers with the last filter, so none are left when the module unloads
+		if (groups_.empty()) {
+			stopping_ = true;
+			workers.swap(workers_);
+			cancelled_spare.swap(spare_);
+			for (const CancellationFlag &flag : running_spare_) {
+				flag->store(true);
+			}
+			work_cv_.notify_all();
+		}
+	}
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+	if (!workers.empty()) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = false;
+	}
+}
+
+std::shared_ptr<TranslationExecutor::GroupState>
+TranslationExecutor::takeTask(TimePoint now, QueuedTask &task, TimePoint &wake_at)
+{
+	for (size_t i = 0; i < groups_.size(); i++) {
+		const size_t index = (next_group_ + i) % groups_.size();
+		const std::shared_ptr<GroupState> &group = groups_[index];
+		if (group->running.size() >= MAX_RUNNING_PER_GROUP) {
+			continue;
+		}
+		// finals go first, a partial of the same speaker is less useful
+		if (!group->pending.empty()) {
+			task = std::move(group->pending.front());
+			group->pending.pop_front();
+			if (group->backlogged &&
+			    (group->pending.empty() || !overLimit(*group))) {
+				group->backlogged = false;
+				obs_log(LOG_INFO, "Translation queue of '%s' caught up",
+					group->name.c_str());
+			}
+			next_group_ = index + 1;
+			return group;
+		}
+		if (group->partial.task && !group->running_partial) {
+			const TimePoint start_at =
+				group->last_partial_start + group->min_partial_interval;
+			if (start_at > now) {
+				wake_at = std::min(wake_at, start_at);
+				continue;
+			}
+			task = std::move(group->partial);
+			group->partial = QueuedTask();
+			group->running_partial = task.cancel;
+			group->last_partial_start = now;
+			next_group_ = index + 1;
+			return group;
+		}
+	}
+	return nullptr;
+}
+
+bool TranslationExecutor::takeSpare(TimePoint now, QueuedTask &task, TimePoint &wake_at)
+{
+	auto first = std::min_element(spare_.begin(), spare_.end(),
+				      [](const QueuedTask &a, const QueuedTask &b) {
+					      return a.queued_at < b.queued_at;
+				      });
+	if (first == spare_.end()) {
+		return false;
+	}
+	if (first->queued_at > now) {
+		wake_at = std::min(wake_at, first->queued_at);
+		return false;
+	}
+	task = std::move(*first);
+	spare_.erase(first);
+	return true;
+}
+
+void TranslationExecutor::workerLoop()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (!stopping_) {
+		QueuedTask queued;
+		TimePoint wake_at = TimePoint::max();
+		const TimePoint now = std::chrono::steady_clock::now();
+		// the groups' tasks go first, a spare task only gets a worker left idle
+		std::shared_ptr<GroupState> group = takeTask(now, queued, wake_at);
+		if (!group && !takeSpare(now, queued, wake_at)) {
+			if (wake_at == TimePoint::max()) {
+				work_cv_.wait(lock);
+			} else {
+				work_cv_.wait_until(lock, wake_at);
+			}
+			continue;
+		}
+
+		metrics_.running++;
+		if (group) {
+			group->running.push_back(queued.cancel);
+			metrics_.queued--;
+			const uint64_t wait_ms = elapsed_ms(queued.queued_at);
+			metrics_.queue_wait_ms += wait_ms;
+			group->metrics.queue_wait_ms += wait_ms;
+		} else {
+			running_spare_.push_back(queued.cancel);
+			metrics_.spare++;
+		}
+
+		lock.unlock();
+		bool failed = false;
+		try {
+			CancellationScope scope(queued.cancel);
+			queued.task();
+		} catch (const std::exception &e) {
+			obs_log(LOG_ERROR, "Translation task failed: %s", e.what());
+			failed = true;
+		} catch (...) {
+			obs_log(LOG_ERROR, "Translation task failed");
+			failed = true;
+		}
+		// release whatever the task captured before its group can be reported idle
+		queued.task = nullptr;
+		lock.lock();
+
+		metrics_.running--;
+		(failed ? metrics_.failed : metrics_.completed)++;
+		if (!group) {
+			running_spare_.erase(std::find(running_spare_.begin(), running_spare_.end(),
+						       queued.cancel));
+			continue;
+		}
+		(failed ? group->metrics.failed : group->metrics.completed)++;
+		group->running.erase(
+			std::find(group->running.begin(), group->running.end(), queued.cancel));
+		if (group->running_partial == queued.cancel) {
+			group->running_partial = nullptr;
+		}
+		if (group->running.empty() && group->closed) {
+			idle_cv_.notify_all();
+		}
+		// the group may have more work that was held back by its running limit
+		work_cv_.notify_one();
+	}
+}
+
+std::shared_ptr<TranslationExecutor::GroupState> TranslationGroup::state()
+{
+	if (closed_) {
+		return nullptr;
+	}
+	if (!state_) {
+		state_ = TranslationExecutor::instance().openGroup(name_);
+		TranslationExecutor::instance().setMinPartialInterval(*state_,
+								      min_partial_interval_);
+	}
+	return state_;
+}
+
+bool TranslationGroup::submit(TranslationExecutor::Task task)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	std::shared_ptr<TranslationExecutor::GroupState> group = state();
+	return group && TranslationExecutor::instance().submit(*group, std::move(task));
+}
+
+void TranslationGroup::submitPartial(TranslationExecutor::Task task)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	std::shared_ptr<TranslationExecutor::GroupState> group = state();
+	if (group) {
+		TranslationExecutor::instance().submitPartial(*group, std::move(task));
+	}
+}
+
+void TranslationGroup::setMinPartialInterval(std::chrono::milliseconds interval)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	min_partial_interval_ = interval;
+	if (state_) {
+		TranslationExecutor::instance().setMinPartialInterval(*state_, interval);
+	}
+}
+
+void TranslationGroup::close()
+{
+	std::shared_ptr<TranslationExecutor::GroupState> group;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		closed_ = true;
+		group.swap(state_);
+	}
+	if (group) {
+		TranslationExecutor::instance().closeGroup(group);
+	}
+}
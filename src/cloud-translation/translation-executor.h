@@ -0,0 +1,145 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/cancellation.h"
+
+// Process-wide pool of translation workers shared by all filters. Each filter submits through
+// its own TranslationGroup; workers take tasks from the groups in turn so a filter with a
+// busy speaker cannot starve the others.
+//
+// Tasks run inside a CancellationScope. A task that was cancelled while running (its group
+// closed, or a newer partial or a final sentence superseded its partial) should check
+// CancellationScope::cancelled() before delivering a result.
+class TranslationExecutor {
+public:
+	typedef std::function<void()> Task;
+
+	struct Metrics {
+		uint64_t submitted = 0;
+		uint64_t completed = 0;
+		uint64_t failed = 0;        // the task threw
+		uint64_t backlogged = 0;    // finals queued past the queue limits
+		uint64_t shed = 0;          // partials skipped while finals were backlogged
+		uint64_t superseded = 0;    // partials replaced by a newer partial or a final
+		uint64_t cancelled = 0;     // still queued when the group was closed
+		uint64_t spare = 0;         // spare tasks started on idle workers
+		uint64_t queue_wait_ms = 0; // total time tasks spent queued
+		size_t queued = 0;
+		size_t running = 0;
+		size_t peak_queued = 0;
+	};
+
+	static TranslationExecutor &instance();
+
+	// Runs task from start_at on a worker that has nothing else to do, so it never holds up
+	// the groups' tasks, e.g. a duplicate request. Returns false if the workers are not
+	// running. The task is destroyed without running if the workers stop first, and it is
+	// cancelled if they stop while it runs.
+	bool submitSpare(Task task, std::chrono::steady_clock::time_point start_at);
+
+	Metrics metrics();
+
+private:
+	friend class TranslationGroup;
+
+	typedef std::chrono::steady_clock::time_point TimePoint;
+
+	struct QueuedTask {
+		Task task;
+		TimePoint queued_at;
+		CancellationFlag cancel;
+		bool partial = false;
+	};
+
+	struct GroupState {
+		std::string name;
+		std::deque<QueuedTask> pending;
+		// latest-wins slot for partial translations, empty when partial.task is not set
+		QueuedTask partial;
+		CancellationFlag running_partial; // set while a partial is being translated
+		TimePoint last_partial_start;
+		std::chrono::milliseconds min_partial_interval{0};
+		std::vector<CancellationFlag> running;
+		bool backlogged = false; // finals were queued past the limits, logged once
+		bool closed = false;
+		Metrics metrics;
+	};
+
+	TranslationExecutor() = default;
+
+	std::shared_ptr<GroupState> openGroup(const std::string &name);
+	bool submit(GroupState &group, Task task);
+	void submitPartial(GroupState &group, Task task);
+	void setMinPartialInterval(GroupState &group, std::chrono::milliseconds interval);
+	void closeGroup(const std::shared_ptr<GroupState> &group);
+
+	void workerLoop();
+	// Takes the next task that may start now, visiting the groups round-robin. When nothing
+	// can start, returns nullptr and lowers wake_at to when a held back partial may start.
+	std::shared_ptr<GroupState> takeTask(TimePoint now, QueuedTask &task, TimePoint &wake_at);
+	// Takes the spare task due first if it is due, lowers wake_at to its start otherwise
+	bool takeSpare(TimePoint now, QueuedTask &task, TimePoint &wake_at);
+	// Cancels the running partial and returns the queued one, to be destroyed by the caller
+	// once the lock is released
+	QueuedTask supersedePartials(GroupState &group);
+	// True while the group's finals, or all queued tasks, are at their limits
+	bool overLimit(const GroupState &group) const;
+
+	std::mutex lifecycle_mutex_; // serializes starting and stopping the workers
+	std::mutex mutex_;
+	std::condition_variable work_cv_;
+	std::condition_variable idle_cv_;
+	std::vector<std::shared_ptr<GroupState>> groups_;
+	size_t next_group_ = 0;
+	std::vector<QueuedTask> spare_; // queued_at is when the task may start
+	std::vector<CancellationFlag> running_spare_;
+	std::vector<std::thread> workers_;
+	bool stopping_ = false;
+	Metrics metrics_;
+};
+
+// A filter's handle on the translation executor. Tasks submitted here may use the filter's
+// data: close() cancels what is still queued or running and waits for running tasks to
+// return, and nothing is submitted after it. The destructor closes the group.
+class TranslationGroup {
+public:
+	explicit TranslationGroup(const std::string &name = "translation") : name_(name) {}
+	~TranslationGroup() { close(); }
+	TranslationGroup(const TranslationGroup &) = delete;
+	TranslationGroup &operator=(const TranslationGroup &) = delete;
+
+	// Queues the translation of a final sentence, which supersedes any partial translation
+	// of the group. Never waits and never drops a final: past the queue limits the group is
+	// backlogged, and its partials are skipped until the finals are caught up. Returns false
+	// if the group is closed.
+	bool submit(TranslationExecutor::Task task);
+
+	// Queues the translation of a partial sentence. Only the newest partial is kept: the
+	// queued one is replaced and the running one is cancelled. Partials start one at a time,
+	// at least the minimum partial interval apart.
+	void submitPartial(TranslationExecutor::Task task);
+
+	void setMinPartialInterval(std::chrono::milliseconds interval);
+
+	void close();
+
+private:
+	// Registers the group with the executor on first use. Returns nullptr once closed.
+	std::shared_ptr<TranslationExecutor::GroupState> state();
+
+	std::string name_;
+	std::mutex mutex_;
+	std::shared_ptr<TranslationExecutor::GroupState> state_;
+	std::chrono::milliseconds min_partial_interval_{0};
+	bool closed_ = false;
+};
@@ -0,0 +1,77 @@
+#include "translation-latency.h"
+
+#include <cmath>
+
+LatencyTracker &LatencyTracker::instance()
+{
+	static LatencyTracker tracker;
+	return tracker;
+}
+
+size_t LatencyTracker::bucketOf(std::chrono::milliseconds latency)
+{
+	const double ms = (double)latency.count();
+	if (ms <= 1.0) {
+		return 0;
+	}
+	const size_t bucket = (size_t)std::ceil(std::log(ms) / std::log(BUCKET_GROWTH));
+	return bucket < BUCKET_COUNT ? bucket : BUCKET_COUNT - 1;
+}
+
+std::chrono::milliseconds LatencyTracker::bucketUpperBound(size_t bucket)
+{
+	return std::chrono::milliseconds((long long)std::ceil(std::pow(BUCKET_GROWTH, bucket)));
+}
+
+void LatencyTracker::record(const std::string &key, std::chrono::milliseconds latency)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	Histogram &histogram = histograms_[key];
+	histogram.counts[bucketOf(latency)]++;
+	histogram.total++;
+	metrics_.samples++;
+	if (histogram.total >= DECAY_SAMPLES) {
+		histogram.total = 0;
+		for (uint32_t &count : histogram.counts) {
+			count /= 2;
+			histogram.total += count;
+		}
+	}
+}
+
+std::chrono::milliseconds LatencyTracker::percentile(const std::string &key, double p)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = histograms_.find(key);
+	if (it == histograms_.end() || it->second.total < MIN_SAMPLES) {
+		return std::chrono::milliseconds(0);
+	}
+	const Histogram &histogram = it->second;
+	const double rank = p * histogram.total;
+	uint32_t seen = 0;
+	for (size_t bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+		seen += histogram.counts[bucket];
+		if (seen >= rank) {
+			return bucketUpperBound(bucket);
+		}
+	}
+	return bucketUpperBound(BUCKET_COUNT - 1);
+}
+
+void LatencyTracker::recordHedged()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	metrics_.hedged++;
+}
+
+void LatencyTracker::recordHedgeWin()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	metrics_.hedge_wins++;
+}
+
+LatencyTracker::Metrics LatencyTracker::metrics()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return metrics_;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Latency histograms per provider endpoint. Translation requests are hedged once they take
+// longer than the endpoint usually does, and their timeouts are derived from its observed
+// percentiles instead of a fixed 30 s.
+class LatencyTracker {
+public:
+	struct Metrics {
+		uint64_t samples = 0;
+		uint64_t hedged = 0;     // requests that got a duplicate
+		uint64_t hedge_wins = 0; // duplicates that answered first
+	};
+
+	// percentiles are not trusted with fewer samples than this
+	static constexpr uint32_t MIN_SAMPLES = 20;
+
+	static LatencyTracker &instance();
+
+	void record(const std::string &key, std::chrono::milliseconds latency);
+
+	// Upper bound of the latency below which a fraction p of requests finished, 0 until
+	// there are MIN_SAMPLES samples
+	std::chrono::milliseconds percentile(const std::string &key, double p);
+
+	// A duplicate request was sent, and whether it answered first
+	void recordHedged();
+	void recordHedgeWin();
+
+	Metrics metrics();
+
+private:
+	// Log-spaced buckets, each about 10% wider than the one before, from 1 ms to a few
+	// minutes
+	static constexpr size_t BUCKET_COUNT = 128;
+	static constexpr double BUCKET_GROWTH = 1.1;
+	// once a histogram holds this many samples all counts are halved, so it follows
+	// changes in the endpoint's latency
+	static constexpr uint32_t DECAY_SAMPLES = 1000;
+
+	struct Histogram {
+		std::array<uint32_t, BUCKET_COUNT> counts{};
+		uint32_t total = 0;
+	};
+
+	static size_t bucketOf(std::chrono::milliseconds latency);
+	static std::chrono::milliseconds bucketUpperBound(size_t bucket);
+
+	std::mutex mutex_;
+	std::unordered_map<std::string, Histogram> histograms_;
+	Metrics metrics_;
+};
@@ -0,0 +1,388 @@
+#include "translation-memory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+#include <obs-module.h>
+#include "plugin-support.h"
+
+static const char MAGIC[4] = {'C', 'V', 'T', 'M'};
+static const uint32_t VERSION = 1;
+static const uint32_t INITIAL_SLOTS = 4096;
+static const size_t INITIAL_RECORD_CAPACITY = 1024 * 1024;
+// the memory stops taking new entries at this size
+static const size_t MAX_FILE_SIZE = 64 * 1024 * 1024;
+// record header: key length and value length
+static const size_t RECORD_HEADER_SIZE = 2 * sizeof(uint32_t);
+
+struct TranslationMemory::Header {
+	char magic[4];
+	uint32_t version;
+	uint32_t slot_count; // power of two
+	uint32_t entry_count;
+	uint64_t records_used; // bytes of the record area in use
+	uint64_t generation;   // odd while the table is being rebuilt
+};
+
+struct TranslationMemory::Slot {
+	uint64_t hash;
+	uint64_t offset; // record offset + 1, 0 for an empty slot
+};
+
+static uint64_t hash_key(const std::string &key)
+{
+	// FNV-1a
+	uint64_t h = 14695981039346656037ull;
+	for (char c : key) {
+		h ^= (uint8_t)c;
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+size_t TranslationMemory::tableSize(uint32_t slot_count)
+{
+	return sizeof(Header) + (size_t)slot_count * sizeof(Slot);
+}
+
+TranslationMemory &TranslationMemory::instance()
+{
+	static TranslationMemory memory([] {
+		std::string path;
+		char *config_path = obs_module_config_path("translation-memory.bin");
+		if (config_path) {
+			path = config_path;
+			bfree(config_path);
+		}
+		return path;
+	}());
+	return memory;
+}
+
+TranslationMemory::Header *TranslationMemory::header() const
+{
+	return (Header *)file_.data();
+}
+
+TranslationMemory::Slot *TranslationMemory::slots() const
+{
+	return (Slot *)(file_.data() + sizeof(Header));
+}
+
+uint8_t *TranslationMemory::records() const
+{
+	return file_.data() + tableSize(header()->slot_count);
+}
+
+size_t TranslationMemory::recordCapacity() const
+{
+	return file_.size() - tableSize(header()->slot_count);
+}
+
+bool TranslationMemory::isValid() const
+{
+	if (file_.size() < sizeof(Header)) {
+		return false;
+	}
+	const Header *h = header();
+	return memcmp(h->magic, MAGIC, sizeof(MAGIC)) == 0 && h->version == VERSION &&
+	       h->slot_count != 0 && (h->slot_count & (h->slot_count - 1)) == 0 &&
+	       tableSize(h->slot_count) <= file_.size() &&
+	       h->records_used <= file_.size() - tableSize(h->slot_count) &&
+	       h->entry_count < h->slot_count;
+}
+
+bool TranslationMemory::initialize(uint32_t slot_count, size_t record_capacity)
+{
+	if (!file_.resize(tableSize(slot_count) + record_capacity)) {
+		return false;
+	}
+	memset(file_.data(), 0, tableSize(slot_count));
+	Header *h = header();
+	h->version = VERSION;
+	h->slot_count = slot_count;
+	h->entry_count = 0;
+	h->records_used = 0;
+	// the magic goes in last, a table interrupted while being written is reinitialized
+	memcpy(h->magic, MAGIC, sizeof(MAGIC));
+	return true;
+}
+
+bool TranslationMemory::ensureOpen()
+{
+	if (file_.isOpen()) {
+		return true;
+	}
+	if (open_attempted_ || path_.empty()) {
+		return false;
+	}
+	open_attempted_ = true;
+
+	std::error_code ec;
+	std::filesystem::create_directories(std::filesystem::u8path(path_).parent_path(), ec);
+	// a new file is created at the initial size and reads as zeros
+	if (!file_.open(path_, tableSize(INITIAL_SLOTS) + INITIAL_RECORD_CAPACITY)) {
+		obs_log(LOG_WARNING, "Failed to open translation memory %s", path_.c_str());
+		return false;
+	}
+	if (file_.isReadOnly()) {
+		// the process writing it initializes it, it is checked on each lookup
+		obs_log(LOG_INFO,
+			"Translation memory %s is in use by another process, reading it only",
+			path_.c_str());
+		return true;
+	}
+	if (!isValid()) {
+		const char no_magic[sizeof(MAGIC)] = {};
+		if (memcmp(header()->magic, no_magic, sizeof(MAGIC)) != 0) {
+			obs_log(LOG_WARNING, "Translation memory %s is not valid, starting over",
+				path_.c_str());
+		}
+		if (!initialize(INITIAL_SLOTS, INITIAL_RECORD_CAPACITY)) {
+			obs_log(LOG_WARNING, "Failed to initialize translation memory");
+			file_.close();
+			return false;
+		}
+	}
+	obs_log(LOG_INFO, "Translation memory opened with %u entries", header()->entry_count);
+	return true;
+}
+
+// Reads the record at offset, false if it runs past the used area
+static bool read_record(const uint8_t *records, uint64_t used, uint64_t offset,
+			std::string *key, std::string *value)
+{
+	if (offset + RECORD_HEADER_SIZE > used) {
+		return false;
+	}
+	uint32_t key_length, value_length;
+	memcpy(&key_length, records + offset, sizeof(key_length));
+	memcpy(&value_length, records + offset + sizeof(key_length), sizeof(value_length));
+	if (offset + RECORD_HEADER_SIZE + key_length + value_length > used) {
+		return false;
+	}
+	const char *data = (const char *)records + offset + RECORD_HEADER_SIZE;
+	if (key) {
+		key->assign(data, key_length);
+	}
+	if (value) {
+		value->assign(data + key_length, value_length);
+	}
+	return true;
+}
+
+static bool record_has_key(const uint8_t *records, uint64_t used, uint64_t offset,
+			   const std::string &key)
+{
+	if (offset + RECORD_HEADER_SIZE > used) {
+		return false;
+	}
+	uint32_t key_length;
+	memcpy(&key_length, records + offset, sizeof(key_length));
+	return key_length == key.size() && offset + RECORD_HEADER_SIZE + key_length <= used &&
+	       memcmp(records + offset + RECORD_HEADER_SIZE, key.data(), key_length) == 0;
+}
+
+TranslationMemory::Slot *TranslationMemory::findSlot(uint64_t hash,
+						     const std::string &key) const
+{
+	const uint32_t mask = header()->slot_count - 1;
+	const uint64_t used = header()->records_used;
+	Slot *table = slots();
+	// the load factor is kept below 0.7, so there is always an empty slot to stop at
+	for (uint32_t i = (uint32_t)hash & mask;; i = (i + 1) & mask) {
+		Slot *slot = &table[i];
+		if (slot->offset == 0 || (slot->hash == hash &&
+					  record_has_key(records(), used, slot->offset - 1, key))) {
+			return slot;
+		}
+	}
+}
+
+void TranslationMemory::append(Slot *slot, uint64_t hash, const std::string &key,
+			       const std::string &value)
+{
+	Header *h = header();
+	uint8_t *record = records() + h->records_used;
+	const uint32_t key_length = (uint32_t)key.size();
+	const uint32_t value_length = (uint32_t)value.size();
+	memcpy(record, &key_length, sizeof(key_length));
+	memcpy(record + sizeof(key_length), &value_length, sizeof(value_length));
+	memcpy(record + RECORD_HEADER_SIZE, key.data(), key.size());
+	memcpy(record + RECORD_HEADER_SIZE + key.size(), value.data(), value.size());
+
+	// publish the slot only once the record is complete
+	const uint64_t offset = h->records_used;
+	h->records_used += RECORD_HEADER_SIZE + key.size() + value.size();
+	std::atomic_thread_fence(std::memory_order_release);
+	if (slot->offset == 0) {
+		h->entry_count++;
+	}
+	slot->hash = hash;
+	slot->offset = offset + 1;
+}
+
+bool TranslationMemory::rebuild(uint32_t slot_count, size_t record_capacity)
+{
+	// copy out the live records, the table and record area are rewritten in place
+	std::vector<std::pair<std::string, std::string>> entries;
+	entries.reserve(header()->entry_count);
+	const uint32_t old_slot_count = header()->slot_count;
+	const uint64_t used = header()->records_used;
+	for (uint32_t i = 0; i < old_slot_count; i++) {
+		const Slot &slot = slots()[i];
+		std::pair<std::string, std::string> entry;
+		if (slot.offset != 0 &&
+		    read_record(records(), used, slot.offset - 1, &entry.first, &entry.second)) {
+			entries.push_back(std::move(entry));
+		}
+	}
+
+	// processes reading the file discard the lookups that overlap the rewrite
+	const uint64_t generation = header()->generation + 1;
+	header()->generation = generation;
+	std::atomic_thread_fence(std::memory_order_release);
+	memset(header()->magic, 0, sizeof(MAGIC));
+	bool rebuilt = initialize(slot_count, record_capacity);
+	if (!rebuilt) {
+		// the old contents are lost, start over with an empty table of the current size
+		initialize(old_slot_count, file_.size() - tableSize(old_slot_count));
+	}
+	header()->generation = generation;
+	if (rebuilt) {
+		for (const auto &entry : entries) {
+			const uint64_t hash = hash_key(entry.first);
+			append(findSlot(hash, entry.first), hash, entry.first, entry.second);
+		}
+	}
+	std::atomic_thread_fence(std::memory_order_release);
+	header()->generation = generation + 1;
+	return rebuilt;
+}
+
+bool TranslationMemory::readShared(const std::string &key, std::string &translation)
+{
+	if (!file_.refresh() || file_.size() < sizeof(Header)) {
+		return false;
+	}
+	// the header is read once and checked against the mapping, the writer may change it
+	const volatile Header *h = header();
+	const uint64_t generation = h->generation;
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const uint32_t slot_count = h->slot_count;
+	const uint64_t used = h->records_used;
+	if ((generation & 1) != 0 || memcmp((const void *)h->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+	    slot_count == 0 || (slot_count & (slot_count - 1)) != 0 ||
+	    tableSize(slot_count) > file_.size() || used > file_.size() - tableSize(slot_count)) {
+		return false;
+	}
+	const uint8_t *records = file_.data() + tableSize(slot_count);
+	const uint64_t hash = hash_key(key);
+	const uint32_t mask = slot_count - 1;
+	bool found = false;
+	uint32_t i = (uint32_t)hash & mask;
+	for (uint32_t probes = 0; probes < slot_count; probes++, i = (i + 1) & mask) {
+		const Slot slot = slots()[i];
+		if (slot.offset == 0) {
+			break;
+		}
+		if (slot.hash == hash && record_has_key(records, used, slot.offset - 1, key)) {
+			found = read_record(records, used, slot.offset - 1, nullptr, &translation);
+			break;
+		}
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return found && h->generation == generation;
+}
+
+bool TranslationMemory::get(const std::string &key, std::string &translation)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (!ensureOpen()) {
+		return false;
+	}
+	if (file_.isReadOnly()) {
+		const bool found = readShared(key, translation);
+		found ? metrics_.hits++ : metrics_.misses++;
+		return found;
+	}
+	const Slot *slot = findSlot(hash_key(key), key);
+	if (slot->offset == 0 ||
+	    !read_record(records(), header()->records_used, slot->offset - 1, nullptr,
+			 &translation)) {
+		metrics_.misses++;
+		return false;
+	}
+	metrics_.hits++;
+	return true;
+}
+
+bool TranslationMemory::put(const std::string &key, const std::string &translation)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (!ensureOpen() || file_.isReadOnly()) {
+		return false;
+	}
+	const uint64_t hash = hash_key(key);
+	const size_t record_size = RECORD_HEADER_SIZE + key.size() + translation.size();
+
+	Slot *slot = findSlot(hash, key);
+	if (slot->offset != 0) {
+		std::string existing;
+		if (read_record(records(), header()->records_used, slot->offset - 1, nullptr,
+				&existing) &&
+		    existing == translation) {
+			return true;
+		}
+	}
+
+	uint32_t slot_count = header()->slot_count;
+	size_t record_capacity = recordCapacity();
+	// keep the load factor below 0.7
+	const bool needs_slots =
+		slot->offset == 0 &&
+		(uint64_t)(header()->entry_count + 1) * 10 > (uint64_t)slot_count * 7;
+	const bool needs_space = header()->records_used + record_size > record_capacity;
+	if (needs_slots || needs_space) {
+		if (needs_slots) {
+			slot_count *= 2;
+		}
+		if (needs_space) {
+			record_capacity = std::max(record_capacity * 2,
+						   (size_t)header()->records_used + record_size);
+		}
+		if (tableSize(slot_count) + record_capacity > MAX_FILE_SIZE) {
+			if (!full_logged_) {
+				obs_log(LOG_WARNING,
+					"Translation memory is full, not adding entries");
+				full_logged_ = true;
+			}
+			return false;
+		}
+		// growing the file also drops the records of replaced values
+		if (!rebuild(slot_count, record_capacity) || !file_.isOpen()) {
+			return false;
+		}
+		// the mapping may have moved
+		slot = findSlot(hash, key);
+	}
+
+	append(slot, hash, key, translation);
+	metrics_.stores++;
+	return true;
+}
+
+TranslationMemory::Metrics TranslationMemory::metrics()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	Metrics metrics = metrics_;
+	if (file_.isOpen() && file_.size() >= sizeof(Header)) {
+		metrics.entries = header()->entry_count;
+		metrics.file_size = file_.size();
+	}
+	return metrics;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "utils/mapped-file.h"
+
+// Translations kept on disk across sessions, so a recurring show starts with the phrases
+// it translated before. The file is a hash table mapped into memory: opening it needs no
+// parsing, a lookup reads the mapped pages directly. Keys are TranslationCache keys.
+//
+// Layout: a header, a power-of-two table of (hash, record offset) slots probed linearly,
+// then the records, each a key length, value length, key and value. Replaced values
+// leave their old record behind until the table is rebuilt, which it is whenever the file
+// grows. One process writes the file, another OBS running at the same time only reads it.
+class TranslationMemory {
+public:
+	struct Metrics {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t stores = 0;
+		uint32_t entries = 0;
+		size_t file_size = 0;
+	};
+
+	// A memory backed by translation-memory.bin in the plugin's config directory
+	static TranslationMemory &instance();
+
+	explicit TranslationMemory(const std::string &path) : path_(path) {}
+
+	// The file is opened on first use. Both return false if it cannot be used.
+	bool get(const std::string &key, std::string &translation);
+	bool put(const std::string &key, const std::string &translation);
+
+	Metrics metrics();
+
+private:
+	struct Header;
+	struct Slot;
+
+	static size_t tableSize(uint32_t slot_count);
+	bool ensureOpen();
+	bool initialize(uint32_t slot_count, size_t record_capacity);
+	bool isValid() const;
+	Header *header() const;
+	Slot *slots() const;
+	uint8_t *records() const;
+	size_t recordCapacity() const;
+	// Slot holding key, or the empty slot where it belongs
+	Slot *findSlot(uint64_t hash, const std::string &key) const;
+	// Writes a record at the end of the record area and points slot at it. The caller
+	// makes sure it fits.
+	void append(Slot *slot, uint64_t hash, const std::string &key, const std::string &value);
+	// Rewrites the table with a new slot count, dropping replaced records
+	bool rebuild(uint32_t slot_count, size_t record_capacity);
+	// Looks key up in a file another process is writing
+	bool readShared(const std::string &key, std::string &translation);
+
+	std::string path_;
+	std::mutex mutex_;
+	MappedFile file_;
+	bool open_attempted_ = false;
+	bool full_logged_ = false;
+	Metrics metrics_;
+};
@@ -0,0 +1,116 @@
+#include "translation-partials.h"
+
+#include <cctype>
+#include <cstring>
+
+// Full-width punctuation ending a clause in CJK text, which has no space after it
+static const char *const WIDE_CLAUSE_ENDS[] = {"\xE3\x80\x82" /* 。 */, "\xE3\x80\x81" /* 、 */,
+					       "\xEF\xBC\x8C" /* ， */, "\xEF\xBC\x81" /* ！ */,
+					       "\xEF\xBC\x9F" /* ？ */, "\xEF\xBC\x9B" /* ； */};
+
+// Position just past the last clause boundary in text[0, limit), 0 if there is none. A
+// boundary is punctuation followed by whitespace, which is included, or full-width
+// punctuation.
+static size_t wide_clause_end_at(const std::string &text, size_t i, size_t limit)
+{
+	for (const char *wide : WIDE_CLAUSE_ENDS) {
+		const size_t length = std::strlen(wide);
+		if (i + length <= limit && text.compare(i, length, wide) == 0) {
+			return length;
+		}
+	}
+	return 0;
+}
+
+static size_t last_clause_end(const std::string &text, size_t limit)
+{
+	size_t end = 0;
+	for (size_t i = 0; i < limit; i++) {
+		const char c = text[i];
+		if (std::strchr(",.;:!?", c) != nullptr && c != '\0') {
+			size_t j = i + 1;
+			while (j < limit && std::isspace((unsigned char)text[j])) {
+				j++;
+			}
+			if (j > i + 1) {
+				end = j;
+			}
+			continue;
+		}
+		const size_t wide_length = wide_clause_end_at(text, i, limit);
+		if (wide_length > 0) {
+			end = i + wide_length;
+		}
+	}
+	return end;
+}
+
+PartialTranslationTracker::Split PartialTranslationTracker::split(const std::string &partial,
+								  size_t target_count)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (translations_.size() != target_count ||
+	    partial.compare(0, committed_.size(), committed_) != 0) {
+		// the transcription revised the committed part, or the targets changed
+		committed_.clear();
+		translations_.assign(target_count, std::string());
+		generation_++;
+	}
+
+	// only what the previous partial already had is stable
+	size_t common = 0;
+	while (common < partial.size() && common < previous_.size() &&
+	       partial[common] == previous_[common]) {
+		common++;
+	}
+	previous_ = partial;
+
+	Split split;
+	split.committed = committed_;
+	split.translations = translations_;
+	split.generation = generation_;
+	const std::string rest = partial.substr(committed_.size());
+	const size_t stable_end =
+		common > committed_.size() ? last_clause_end(rest, common - committed_.size()) : 0;
+	split.stable = rest.substr(0, stable_end);
+	split.tail = rest.substr(stable_end);
+	return split;
+}
+
+void PartialTranslationTracker::commit(const Split &split,
+				       const std::vector<std::string> &stable_translations)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (generation_ != split.generation || committed_ != split.committed ||
+	    stable_translations.size() != translations_.size()) {
+		return;
+	}
+	committed_ += split.stable;
+	for (size_t i = 0; i < translations_.size(); i++) {
+		translations_[i] = join(translations_[i], stable_translations[i]);
+	}
+}
+
+void PartialTranslationTracker::reset()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	previous_.clear();
+	committed_.clear();
+	translations_.clear();
+	generation_++;
+}
+
+std::string PartialTranslationTracker::join(const std::string &prefix, const std::string &rest)
+{
+	if (prefix.empty()) {
+		return rest;
+	}
+	const size_t wide_length = 3;
+	if (rest.empty() || std::isspace((unsigned char)prefix.back()) ||
+	    (prefix.size() >= wide_length &&
+	     wide_clause_end_at(prefix, prefix.size() - wide_length, prefix.size()) > 0)) {
+		// no space after full-width punctuation
+		return prefix + rest;
+	}
+	return prefix + " " + rest;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Lets a growing partial be translated piece by piece instead of from scratch every time.
+// The partial is split into a committed prefix, which ends at a clause boundary and has
+// already been translated, and the tail after it, the only part sent again as the partial
+// grows. A clause becomes committed once it is the same in two partials in a row.
+class PartialTranslationTracker {
+public:
+	struct Split {
+		std::string committed;                 // prefix translated before
+		std::vector<std::string> translations; // its translation, one per target language
+		std::string stable;                    // clauses that just became stable
+		std::string tail;                      // the rest of the partial
+		uint64_t generation = 0;
+	};
+
+	// Splits a partial translated into target_count languages
+	Split split(const std::string &partial, size_t target_count);
+
+	// Commits the translations of split.stable. Ignored if the tracker was reset or moved
+	// on since split() returned it.
+	void commit(const Split &split, const std::vector<std::string> &stable_translations);
+
+	// Starts over, at the end of an utterance
+	void reset();
+
+	// Joins a translated prefix and the translation of what follows it
+	static std::string join(const std::string &prefix, const std::string &rest);
+
+private:
+	std::mutex mutex_;
+	std::string previous_;
+	std::string committed_;
+	std::vector<std::string> translations_;
+	uint64_t generation_ = 0; // bumped whenever the committed prefix starts over
+};
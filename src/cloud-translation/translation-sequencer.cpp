@@ -0,0 +1,123 @@
+#include "translation-sequencer.h"
+
+#include <vector>
+
+TranslationSequencer::Ticket::~Ticket()
+{
+	if (!completed_) {
+		sequencer_.finish(sequence_, nullptr);
+	}
+}
+
+void TranslationSequencer::Ticket::complete(Delivery deliver)
+{
+	completed_ = true;
+	sequencer_.finish(sequence_, std::move(deliver));
+}
+
+void TranslationSequencer::Ticket::progress(const Delivery &deliver)
+{
+	if (!completed_) {
+		sequencer_.progress(sequence_, deliver);
+	}
+}
+
+std::shared_ptr<TranslationSequencer::Ticket> TranslationSequencer::begin(uint64_t sequence,
+									  bool partial)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	entries_[sequence] = Entry{partial, false, nullptr};
+	return std::shared_ptr<Ticket>(new Ticket(*this, sequence));
+}
+
+TranslationSequencer::Metrics TranslationSequencer::metrics()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return metrics_;
+}
+
+void TranslationSequencer::progress(uint64_t sequence, const Delivery &deliver)
+{
+	std::lock_guard<std::mutex> delivery_lock(delivery_mutex_);
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (sequence < last_delivered_) {
+			return;
+		}
+		// an earlier final still waiting would be overwritten
+		for (auto it = entries_.begin(); it != entries_.end() && it->first < sequence;
+		     ++it) {
+			if (!it->second.partial) {
+				return;
+			}
+		}
+		// earlier partials finishing after this are stale
+		last_delivered_ = sequence;
+	}
+	deliver();
+}
+
+void TranslationSequencer::finish(uint64_t sequence, Delivery deliver)
+{
+	std::lock_guard<std::mutex> delivery_lock(delivery_mutex_);
+	std::vector<Delivery> ready;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = entries_.find(sequence);
+		if (it == entries_.end()) {
+			return;
+		}
+		if (!deliver) {
+			metrics_.abandoned++;
+			entries_.erase(it);
+		} else if (sequence < last_delivered_) {
+			// only partials can complete behind a delivered result, finals wait for it
+			metrics_.stale++;
+			entries_.erase(it);
+		} else {
+			it->second.done = true;
+			it->second.deliver = std::move(deliver);
+		}
+
+		// release everything up to the first final that is still being translated.
+		// Unfinished partials do not hold anything back, they are stale once they finish.
+		it = entries_.begin();
+		while (it != entries_.end()) {
+			if (!it->second.done) {
+				if (!it->second.partial) {
+					break;
+				}
+				++it;
+				continue;
+			}
+			bool superseded = false;
+			if (it->second.partial) {
+				for (auto next = std::next(it); next != entries_.end(); ++next) {
+					if (next->second.done) {
+						superseded = true;
+						break;
+					}
+					if (!next->second.partial) {
+						break;
+					}
+				}
+			}
+			if (superseded) {
+				metrics_.stale++;
+			} else {
+				ready.push_back(std::move(it->second.deliver));
+				last_delivered_ = it->first;
+				metrics_.delivered++;
+			}
+			it = entries_.erase(it);
+		}
+
+		it = entries_.find(sequence);
+		if (it != entries_.end() && it->second.done) {
+			metrics_.reordered++;
+		}
+	}
+	for (Delivery &d : ready) {
+		d();
+	}
+}
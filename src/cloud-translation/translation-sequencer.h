@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+// Puts asynchronous translation results back in transcription order before they reach the
+// caption, file and metadata outputs. Translations finish in any order; a result is passed
+// on as soon as every earlier final sentence has been passed on or abandoned, so results
+// that complete in order are never delayed. A partial is dropped when a later result has
+// already been passed on, or is ready to go out with it.
+class TranslationSequencer {
+public:
+	typedef std::function<void()> Delivery;
+
+	struct Metrics {
+		uint64_t delivered = 0;
+		uint64_t reordered = 0; // held back until an earlier final was delivered
+		uint64_t stale = 0;     // partials dropped because a newer result went out first
+		uint64_t abandoned = 0; // never completed (failed, cancelled or dropped)
+	};
+
+	// One result in flight. Destroying a ticket that was not completed abandons the result,
+	// so a translation task that is dropped or fails releases whatever waits behind it.
+	class Ticket {
+	public:
+		~Ticket();
+		Ticket(const Ticket &) = delete;
+		Ticket &operator=(const Ticket &) = delete;
+
+		// deliver passes the result to the outputs. It is called on the calling thread or
+		// on the thread that completes the result it waited for.
+		void complete(Delivery deliver);
+
+		// Passes an intermediate result, e.g. a translation still being streamed, to the
+		// outputs right away if nothing earlier is waiting for delivery, and skips it
+		// otherwise. Earlier partials finishing after it are dropped as stale.
+		void progress(const Delivery &deliver);
+
+	private:
+		friend class TranslationSequencer;
+		Ticket(TranslationSequencer &sequencer, uint64_t sequence)
+			: sequencer_(sequencer),
+			  sequence_(sequence)
+		{
+		}
+
+		TranslationSequencer &sequencer_;
+		uint64_t sequence_;
+		bool completed_ = false;
+	};
+
+	// Registers a result in transcription order. The sequencer must outlive its tickets.
+	std::shared_ptr<Ticket> begin(uint64_t sequence, bool partial);
+
+	Metrics metrics();
+
+private:
+	struct Entry {
+		bool partial;
+		bool done = false;
+		Delivery deliver; // empty for abandoned results
+	};
+
+	void finish(uint64_t sequence, Delivery deliver);
+	void progress(uint64_t sequence, const Delivery &deliver);
+
+	std::mutex mutex_;
+	// serializes running deliveries so they leave in the order they were released
+	std::mutex delivery_mutex_;
+	std::map<uint64_t, Entry> entries_;
+	uint64_t last_delivered_ = 0;
+	Metrics metrics_;
+};
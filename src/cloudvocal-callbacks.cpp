@@ -7,13 +7,12 @@
 
 #include <curl/curl.h>
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
-#include <regex>
 #include <string>
 #include <vector>
 #include <filesystem>
-#include <thread>
 #include <functional>
 
 #include "cloudvocal-callbacks.h"
@@ -27,14 +26,25 @@ void send_caption_to_source(const std::string &target_source_name, const std::st
 	if (target_source_name.empty() || !gf->active || gf->context == nullptr) {
 		return;
 	}
-	auto target = obs_get_source_by_name(target_source_name.c_str());
+	// pushed by update_caption_source, only the latest caption before each push is shown
+	gf->caption_mailbox.post(target_source_name, caption);
+}
+
+void update_caption_source(const std::string &target_source_name, const std::string &caption,
+			   struct cloudvocal_data *gf)
+{
+	obs_source_t *target = gf->caption_sources.get(target_source_name);
 	if (!target) {
 		obs_log(gf->log_level, "text_source target is null");
 		return;
 	}
 	auto text_settings = obs_source_get_settings(target);
-	obs_data_set_string(text_settings, "text", caption.c_str());
-	obs_source_update(target, text_settings);
+	// updating the source lays out and rasterizes the text again, even when it is the same
+	if (caption != obs_data_get_string(text_settings, "text")) {
+		obs_data_set_string(text_settings, "text", caption.c_str());
+		obs_source_update(target, text_settings);
+	}
+	obs_data_release(text_settings);
 	obs_source_release(target);
 }
 
@@ -49,41 +59,178 @@ void audio_chunk_callback(struct cloudvocal_data *gf, const float *pcm32f_data,
 	// stub
 }
 
-void send_sentence_to_cloud_translation_async(const std::string &sentence,
-					      struct cloudvocal_data *gf,
-					      const std::string &source_language,
-					      std::function<void(const std::string &)> callback)
+// Translates a partial piece by piece, see PartialTranslationTracker. Only the clauses that
+// just became stable and the tail after them are sent, the rest was translated for earlier
+// partials.
+static std::vector<std::string>
+translate_partial_incrementally(struct cloudvocal_data *gf, const CloudTranslatorConfig &config,
+				const std::string &partial,
+				const std::vector<std::string> &target_langs,
+				const std::string &source_language, TranslationMemoryUse memory_use,
+				const TranslationProgressCallback &on_progress)
+{
+	const RequestPriority priority = REQUEST_PRIORITY_PARTIAL;
+	const PartialTranslationTracker::Split split =
+		gf->partial_tracker.split(partial, target_langs.size());
+	std::vector<std::string> prefixes = split.translations;
+	std::string tail = split.tail;
+	if (!split.stable.empty()) {
+		const std::vector<std::string> stable = translate_cloud_multi(
+			gf->translator_cache, config, split.stable, target_langs, source_language,
+			memory_use, nullptr, priority);
+		if (std::find(stable.begin(), stable.end(), std::string()) == stable.end()) {
+			gf->partial_tracker.commit(split, stable);
+			for (size_t i = 0; i < prefixes.size(); i++) {
+				prefixes[i] =
+					PartialTranslationTracker::join(prefixes[i], stable[i]);
+			}
+		} else {
+			// try again with the next partial
+			tail = split.stable + split.tail;
+		}
+	}
+	if (tail.empty()) {
+		return prefixes;
+	}
+
+	const std::vector<std::string> tails = translate_cloud_multi(
+		gf->translator_cache, config, tail, target_langs, source_language, memory_use,
+		[&prefixes, &on_progress](const std::string &text) {
+			on_progress(PartialTranslationTracker::join(prefixes[0], text));
+		},
+		priority);
+	std::vector<std::string> translations(target_langs.size());
+	for (size_t i = 0; i < translations.size(); i++) {
+		if (!tails[i].empty()) {
+			translations[i] = PartialTranslationTracker::join(prefixes[i], tails[i]);
+		}
+	}
+	return translations;
+}
+
+// Translates the sentence into every translation target. The callback receives the targets
+// and their translations, in the same order, an empty translation where one failed.
+void send_sentence_to_cloud_translation_async(
+	const std::string &sentence, struct cloudvocal_data *gf,
+	const DetectionResultWithText &result,
+	std::function<void(const std::vector<TranslationTarget> &,
+			   const std::vector<std::string> &)>
+		callback)
 {
-	const std::string last_text = gf->last_text_for_translation;
-	gf->last_text_for_translation = sentence;
-	if (gf->translate && !sentence.empty() && gf->active) {
-		obs_log(gf->log_level, "Translating text with cloud provider %s. %s -> %s",
+	const std::string &source_language = result.language;
+	std::string last_text;
+	std::vector<std::string> last_translations;
+	{
+		std::lock_guard<std::mutex> lock(gf->last_translation_mutex);
+		last_text = gf->last_text_for_translation;
+		gf->last_text_for_translation = sentence;
+		last_translations = gf->last_text_translations;
+	}
+	const std::vector<TranslationTarget> targets = gf->translation_targets;
+	if (gf->translate && !sentence.empty() && gf->active && !targets.empty()) {
+		obs_log(gf->log_level,
+			"Translating text with cloud provider %s. %s -> %s (%zu languages)",
 			gf->translate_cloud_config.provider.c_str(), source_language.c_str(),
-			gf->target_lang.c_str());
-		if (sentence == last_text) {
+			targets[0].language.c_str(), targets.size());
+		// translations reach the outputs in transcription order, whenever they finish
+		std::shared_ptr<TranslationSequencer::Ticket> ticket =
+			gf->translation_sequencer.begin(result.sequence,
+							result.result == DETECTION_RESULT_PARTIAL);
+		if (sentence == last_text && last_translations.size() == targets.size()) {
 			// do not translate the same sentence twice
-			callback(gf->last_text_translation);
+			ticket->complete([callback, targets, last_translations]() {
+				callback(targets, last_translations);
+			});
 			return;
 		}
 
-		std::thread([sentence, gf, source_language, callback]() {
-			std::string translated_text;
-			translated_text = translate_cloud(gf->translate_cloud_config, sentence,
-							  gf->target_lang, source_language);
-			if (!translated_text.empty()) {
+		// only final sentences are remembered across sessions, partials rarely recur
+		TranslationMemoryUse memory_use = TRANSLATION_MEMORY_OFF;
+		if (gf->translation_memory) {
+			memory_use = result.result == DETECTION_RESULT_PARTIAL
+					     ? TRANSLATION_MEMORY_READ
+					     : TRANSLATION_MEMORY_READ_WRITE;
+		}
+
+		// one task translates into all targets, the languages share the request where the
+		// provider allows it and are requested concurrently otherwise
+		const bool partial = result.result == DETECTION_RESULT_PARTIAL;
+		const bool incremental = partial && gf->incremental_partials;
+		if (!partial) {
+			// the utterance is over, the next partial starts a new one
+			gf->partial_tracker.reset();
+		}
+		auto task = [sentence, gf, source_language, callback, ticket, memory_use, targets,
+			     partial, incremental, config = gf->translate_cloud_config]() {
+			std::vector<std::string> target_langs;
+			for (const TranslationTarget &target : targets) {
+				target_langs.push_back(target.language);
+			}
+			// a provider that streams shows the first language in its caption while the
+			// translation is generated, the files and metadata get the finished text
+			const std::string caption_source = targets[0].output == "none"
+								   ? gf->text_source_name
+								   : targets[0].output;
+			auto on_progress = [gf, ticket, &caption_source](const std::string &text) {
+				ticket->progress([gf, &caption_source, &text]() {
+					send_caption_to_source(caption_source, text, gf);
+				});
+			};
+			const std::vector<std::string> translations =
+				incremental ? translate_partial_incrementally(
+						      gf, config, sentence, target_langs,
+						      source_language, memory_use, on_progress)
+					    : translate_cloud_multi(
+						      gf->translator_cache, config, sentence,
+						      target_langs, source_language, memory_use,
+						      on_progress,
+						      partial ? REQUEST_PRIORITY_PARTIAL
+							      : REQUEST_PRIORITY_FINAL);
+			if (CancellationScope::cancelled()) {
+				// superseded by a newer sentence, or the filter is being destroyed
+				return;
+			}
+			bool translated = false;
+			for (size_t i = 0; i < translations.size(); i++) {
+				if (translations[i].empty()) {
+					obs_log(gf->log_level, "Failed to translate text into %s",
+						target_langs[i].c_str());
+					continue;
+				}
+				translated = true;
 				if (gf->log_words) {
-					obs_log(LOG_INFO, "Cloud Translation: '%s' -> '%s'",
-						sentence.c_str(), translated_text.c_str());
+					obs_log(LOG_INFO, "Cloud Translation: '%s' -> '%s' (%s)",
+						sentence.c_str(), translations[i].c_str(),
+						target_langs[i].c_str());
+				}
+				if (!partial) {
+					// context for the next sentences
+					remember_translation(gf->translator_cache, config, sentence,
+							     translations[i], target_langs[i],
+							     source_language);
+				}
+			}
+			if (translated) {
+				{
+					// tasks of the group run concurrently
+					std::lock_guard<std::mutex> lock(
+						gf->last_translation_mutex);
+					gf->last_text_translations = translations;
 				}
-				gf->last_text_translation = translated_text;
-				callback(translated_text);
-			} else {
-				obs_log(gf->log_level, "Failed to translate text");
+				ticket->complete([callback, targets, translations]() {
+					callback(targets, translations);
+				});
 			}
-		}).detach();
+		};
+		if (result.result == DETECTION_RESULT_PARTIAL) {
+			// only the newest partial is translated, older ones are already outdated
+			gf->translation_group.submitPartial(task);
+		} else {
+			gf->translation_group.submit(task);
+		}
 		return;
 	}
-	callback("");
+	callback(targets, std::vector<std::string>(targets.size()));
 }
 
 void send_sentence_to_file(struct cloudvocal_data *gf, const DetectionResultWithText &result,
@@ -157,20 +304,20 @@ void send_sentence_to_file(struct cloudvocal_data *gf, const DetectionResultWith
 void send_translated_sentence_to_file(struct cloudvocal_data *gf,
 				      const DetectionResultWithText &result,
 				      const std::string &translated_sentence,
-				      const std::string &target_lang)
+				      const std::string &file_suffix)
 {
 	// if translation is enabled, save the translated sentence to another file
 	if (translated_sentence.empty()) {
 		obs_log(gf->log_level, "Translation is empty, not saving to file");
 	} else {
-		// add a postfix to the file name (without extension) with the translation target language
+		// add a postfix to the file name (without extension), the language by default
 		std::string translated_file_path = "";
 		std::string output_file_path = gf->output_file_path;
 		std::string file_extension =
 			output_file_path.substr(output_file_path.find_last_of(".") + 1);
 		std::string file_name =
 			output_file_path.substr(0, output_file_path.find_last_of("."));
-		translated_file_path = file_name + "_" + target_lang + "." + file_extension;
+		translated_file_path = file_name + "_" + file_suffix + "." + file_extension;
 		send_sentence_to_file(gf, result, translated_sentence, translated_file_path, false);
 	}
 }
@@ -204,23 +351,30 @@ void send_caption_to_stream(DetectionResultWithText result, const std::string &s
 	obs_websocket_request_response_free(response);
 }
 
+static RequestPriority metadata_priority(const DetectionResultWithText &result)
+{
+	return result.result == DETECTION_RESULT_PARTIAL ? REQUEST_PRIORITY_PARTIAL
+							 : REQUEST_PRIORITY_FINAL;
+}
+
 void set_text_callback(struct cloudvocal_data *gf, const DetectionResultWithText &resultIn)
 {
+	if (resultIn.result == DETECTION_RESULT_PARTIAL && !gf->partial_transcription) {
+		// partial transcription is disabled, wait for the final result
+		return;
+	}
+
 	DetectionResultWithText result = resultIn;
+	result.sequence = ++gf->result_sequence;
 
 	std::string str_copy = result.text;
 
 	// if suppression is enabled, check if the text is in the suppression list
-	if (!gf->filter_words_replace.empty()) {
+	const std::shared_ptr<const WordFilter> word_filter = std::atomic_load(&gf->word_filter);
+	if (word_filter) {
 		const std::string original_str_copy = str_copy;
-		// check if the text is in the suppression list
-		for (const auto &filter_words : gf->filter_words_replace) {
-			// if filter exists within str_copy, replace it with the replacement
-			str_copy = std::regex_replace(str_copy,
-						      std::regex(std::get<0>(filter_words),
-								 std::regex_constants::icase),
-						      std::get<1>(filter_words));
-		}
+		// replace every word of the suppression list found in the text
+		str_copy = word_filter->apply(str_copy);
 		// if the text was modified, log the original and modified text
 		if (original_str_copy != str_copy) {
 			obs_log(gf->log_level, "------ Suppressed text: '%s' -> '%s'",
@@ -237,32 +391,43 @@ void set_text_callback(struct cloudvocal_data *gf, const DetectionResultWithText
 
 	if (should_translate) {
 		send_sentence_to_cloud_translation_async(
-			str_copy, gf, result.language,
-			[gf, result](const std::string &translated_sentence_cloud) {
-				if (gf->translation_output != "none") {
-					send_caption_to_source(gf->translation_output,
-							       translated_sentence_cloud, gf);
-				} else {
-					// overwrite the original text with the translated text
-					send_caption_to_source(gf->text_source_name,
-							       translated_sentence_cloud, gf);
-				}
-				if (gf->save_to_file && gf->output_file_path != "") {
-					send_translated_sentence_to_file(gf, result,
-									 translated_sentence_cloud,
-									 gf->target_lang);
-				}
-				if (gf->send_timed_metadata) {
-					send_timed_metadata_to_server(gf, SOURCE_AND_TARGET,
-								      result.text, result.language,
-								      translated_sentence_cloud,
-								      gf->target_lang);
+			str_copy, gf, result,
+			[gf, result](const std::vector<TranslationTarget> &targets,
+				     const std::vector<std::string> &translations) {
+				for (size_t i = 0; i < targets.size(); i++) {
+					const TranslationTarget &target = targets[i];
+					const std::string &translation = translations[i];
+					if (translation.empty()) {
+						// failed or cancelled, keep what the output shows
+						continue;
+					}
+					if (i == 0 && target.output == "none") {
+						// overwrite the original text with the translation
+						send_caption_to_source(gf->text_source_name,
+								       translation, gf);
+					} else {
+						send_caption_to_source(target.output, translation,
+								       gf);
+					}
+					if (gf->save_to_file && gf->output_file_path != "") {
+						send_translated_sentence_to_file(
+							gf, result, translation,
+							target.file_suffix.empty()
+								? target.language
+								: target.file_suffix);
+					}
+					if (gf->send_timed_metadata && target.metadata) {
+						send_timed_metadata_to_server(
+							gf, SOURCE_AND_TARGET, result.text,
+							result.language, translation,
+							target.language, metadata_priority(result));
+					}
 				}
 			});
 	} else {
 		if (gf->send_timed_metadata) {
 			send_timed_metadata_to_server(gf, ONLY_SOURCE, result.text, result.language,
-						      "", "");
+						      "", "", metadata_priority(result));
 		}
 	}
 
@@ -369,10 +534,16 @@ void recording_state_callback(enum obs_frontend_event event, void *data)
 void clear_current_caption(cloudvocal_data *gf_)
 {
 	send_caption_to_source(gf_->text_source_name, "", gf_);
-	send_caption_to_source(gf_->translation_output, "", gf_);
+	for (const TranslationTarget &target : gf_->translation_targets) {
+		send_caption_to_source(target.output, "", gf_);
+	}
 	// reset translation context
-	gf_->last_text_for_translation = "";
-	gf_->last_text_translation = "";
+	{
+		std::lock_guard<std::mutex> lock(gf_->last_translation_mutex);
+		gf_->last_text_for_translation = "";
+		gf_->last_text_translations.clear();
+	}
+	gf_->partial_tracker.reset();
 	gf_->last_transcription_sentence.clear();
 	gf_->cleared_last_sub = true;
 }
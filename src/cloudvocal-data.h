@@ -1,15 +1,24 @@
 #pragma once
 
 #include <string>
+#include <atomic>
 #include <map>
 #include <mutex>
 #include <condition_variable>
 #include <memory>
 #include <deque>
+#include <vector>
 #include <obs-module.h>
 #include <media-io/audio-resampler.h>
 
 #include "cloud-translation/translation-cloud.h"
+#include "cloud-translation/translation-executor.h"
+#include "cloud-translation/translation-partials.h"
+#include "cloud-translation/translation-sequencer.h"
+#include "utils/caption-mailbox.h"
+#include "utils/http-engine.h"
+#include "utils/source-cache.h"
+#include "utils/word-filter.h"
 
 #define TRANSCRIPTION_SAMPLE_RATE 16000
 
@@ -26,16 +35,49 @@ enum DetectionResult {
 	DETECTION_RESULT_PARTIAL = 3
 };
 
+// Sample encodings a cloud provider can accept, used as flags in its capabilities
+enum AudioEncoding : uint32_t {
+	AUDIO_ENCODING_PCM_S16LE = 1 << 0,
+	AUDIO_ENCODING_MULAW = 1 << 1,
+};
+
+// Sample rate the audio is sent to the provider at
+enum AudioBandwidthMode {
+	AUDIO_BANDWIDTH_NATIVE = 0,    // the OBS mix rate when the provider accepts it
+	AUDIO_BANDWIDTH_WIDEBAND = 1,  // TRANSCRIPTION_SAMPLE_RATE
+	AUDIO_BANDWIDTH_TELEPHONY = 2, // 8 kHz, mu-law where supported
+};
+
+// Audio format and pipeline stages chosen for the current cloud provider session
+struct AudioSessionConfig {
+	uint32_t sample_rate;           // rate the audio is sent at
+	AudioEncoding encoding;         // how samples are encoded on the wire
+	size_t frame_samples;           // samples per chunk sent to the provider
+	size_t max_chunk_samples;       // largest chunk, used when catching up on a backlog
+	bool resample;                  // false when the input can be sent at its own rate
+	bool partial_results;           // request interim results from the provider
+	uint32_t keepalive_interval_ms; // 0 when the provider needs no keepalives
+};
+
 struct DetectionResultWithText {
 	uint64_t start_timestamp_ms;
 	uint64_t end_timestamp_ms;
 	std::string text;
 	std::string language;
 	enum DetectionResult result;
+	uint64_t sequence = 0; // per-filter transcription order, assigned in set_text_callback
 };
 
 class CloudProvider;
 
+// A language the transcription is translated into and where its translation goes
+struct TranslationTarget {
+	std::string language;    // target language code, e.g. __es__
+	std::string output;      // text source for the translation, empty for none
+	std::string file_suffix; // added to the output file name, the language code if empty
+	bool metadata;           // send the translation as timed metadata
+};
+
 struct TimedMetadataConfig {
 	std::string aws_access_key;
 	std::string aws_secret_key;
@@ -49,6 +91,8 @@ struct cloudvocal_data {
 	bool initial_creation;
 	bool source_signals_set;
 	obs_source_t *context;
+	// keeps the HTTP engine running, released after everything below that makes requests
+	HttpEngineUse http_engine_use;
 
 	size_t channels;
 	int sample_rate;
@@ -70,6 +114,10 @@ struct cloudvocal_data {
 	// Transcription options
 	std::string language;
 	std::string text_source_name;
+	// the text sources captions are sent to, by name
+	SourceCache caption_sources;
+	// latest caption per text source, pushed at most once per caption_update_rate interval
+	CaptionMailbox caption_mailbox;
 	bool caption_to_stream;
 	bool process_while_muted;
 	uint64_t last_sub_render_time;
@@ -79,13 +127,20 @@ struct cloudvocal_data {
 	int min_sub_duration;
 	int max_sub_duration;
 	bool log_words;
+	bool partial_transcription;
+	// minimum provider stability for an interim result to be shown as a partial
+	float partial_stability_threshold;
 	// smart pointer to the cloud provider
 	std::shared_ptr<CloudProvider> cloud_provider;
 	std::string cloud_provider_selection;
 	std::string cloud_provider_api_key;
 	std::string cloud_provider_secret_key;
+	AudioBandwidthMode audio_bandwidth_mode;
+	AudioSessionConfig audio_session;
 
 	std::map<std::string, std::string> filter_words_replace;
+	// built from filter_words_replace on update, swapped with std::atomic_store
+	std::shared_ptr<const WordFilter> word_filter;
 
 	// Translation options
 	bool translate_only_full_sentences;
@@ -93,8 +148,20 @@ struct cloudvocal_data {
 	std::string translation_output;
 	std::string target_lang;
 	std::string last_text_for_translation;
-	std::string last_text_translation;
+	std::vector<std::string> last_text_translations;
+	// guards the last text and translations, written by the translation workers
+	std::mutex last_translation_mutex;
+	// the primary target from the translation settings followed by the extra targets
+	std::vector<TranslationTarget> translation_targets;
 	CloudTranslatorConfig translate_cloud_config;
+	bool translation_memory;
+	// translate partials clause by clause, reusing the translation of stable clauses
+	bool incremental_partials;
+	PartialTranslationTracker partial_tracker;
+	TranslatorCache translator_cache;
+	TranslationSequencer translation_sequencer;
+	TranslationGroup translation_group;
+	std::atomic<uint64_t> result_sequence{0};
 
 	// Timed metadata options
 	bool send_timed_metadata;
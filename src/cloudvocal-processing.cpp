@@ -5,6 +5,7 @@
 #include <obs-module.h>
 #include <obs.h>
 
+#include <algorithm>
 #include <vector>
 #include "plugin-support.h"
 
@@ -89,22 +90,40 @@ int get_data_from_buf_and_resample(cloudvocal_data *gf, uint64_t &start_timestam
 		return 1;
 	}
 
+	if (!gf->audio_session.resample) {
+		// the provider takes the input rate, so the audio only needs a downmix to mono
+		if (gf->channels == 1) {
+			gf->resampled_buffer.insert(gf->resampled_buffer.end(),
+						    copy_buffers[0].begin(), copy_buffers[0].end());
+			return 0;
+		}
+		const float scale = 1.0f / (float)gf->channels;
+		for (size_t i = 0; i < num_frames_from_infos; i++) {
+			float sum = 0.0f;
+			for (size_t c = 0; c < gf->channels; c++) {
+				sum += copy_buffers[c][i];
+			}
+			gf->resampled_buffer.push_back(sum * scale);
+		}
+		return 0;
+	}
+
 	if (gf->resampler == nullptr) {
 		obs_log(LOG_ERROR, "Resampler is not initialized");
 		return 1;
 	}
 
 	{
-		// resample to 16kHz
-		float *resampled_16khz[8];
-		uint32_t resampled_16khz_frames;
+		// resample to the session rate
+		float *resampled[8];
+		uint32_t resampled_frames;
 		uint64_t ts_offset;
 		uint8_t *copy_buffers_8[8];
 		for (size_t c = 0; c < gf->channels; c++) {
 			copy_buffers_8[c] = (uint8_t *)copy_buffers[c].data();
 		}
-		bool success = audio_resampler_resample(gf->resampler, (uint8_t **)resampled_16khz,
-							&resampled_16khz_frames, &ts_offset,
+		bool success = audio_resampler_resample(gf->resampler, (uint8_t **)resampled,
+							&resampled_frames, &ts_offset,
 							(const uint8_t **)copy_buffers_8,
 							(uint32_t)num_frames_from_infos);
 
@@ -114,16 +133,53 @@ int get_data_from_buf_and_resample(cloudvocal_data *gf, uint64_t &start_timestam
 		}
 
 		// push back resampled data to resampled buffer
-		gf->resampled_buffer.insert(gf->resampled_buffer.end(), resampled_16khz[0],
-					    resampled_16khz[0] + resampled_16khz_frames);
+		gf->resampled_buffer.insert(gf->resampled_buffer.end(), resampled[0],
+					    resampled[0] + resampled_frames);
 #ifdef CLOUDVOCAL_EXTRA_VERBOSE
 		obs_log(gf->log_level,
 			"resampled: %d channels, %d frames, %f ms, current size: %lu bytes",
-			(int)gf->channels, (int)resampled_16khz_frames,
-			(float)resampled_16khz_frames / TRANSCRIPTION_SAMPLE_RATE * 1000.0f,
+			(int)gf->channels, (int)resampled_frames,
+			(float)resampled_frames / gf->audio_session.sample_rate * 1000.0f,
 			gf->resampled_buffer.size);
 #endif
 	}
 
 	return 0;
 }
+
+static uint8_t linear_to_mulaw(int16_t pcm)
+{
+	const int bias = 0x84;
+	const int clip = 32635;
+
+	const int sign = pcm < 0 ? 0x80 : 0;
+	const int magnitude = std::min(pcm < 0 ? -(int)pcm : (int)pcm, clip) + bias;
+	int exponent = 7;
+	for (int mask = 0x4000; (magnitude & mask) == 0 && exponent > 0; mask >>= 1) {
+		exponent--;
+	}
+	const int mantissa = (magnitude >> (exponent + 3)) & 0x0f;
+	return (uint8_t)~(sign | (exponent << 4) | mantissa);
+}
+
+void encode_audio_samples(const std::deque<float> &samples, AudioEncoding encoding,
+			  std::vector<uint8_t> &out)
+{
+	out.clear();
+	if (encoding == AUDIO_ENCODING_MULAW) {
+		out.reserve(samples.size());
+		for (float sample : samples) {
+			const float clamped = std::max(-1.0f, std::min(1.0f, sample));
+			out.push_back(linear_to_mulaw((int16_t)(clamped * 32767.0f)));
+		}
+		return;
+	}
+
+	out.reserve(samples.size() * sizeof(int16_t));
+	for (float sample : samples) {
+		const float clamped = std::max(-1.0f, std::min(1.0f, sample));
+		const int16_t pcm = (int16_t)(clamped * 32767.0f);
+		out.push_back((uint8_t)(pcm & 0xff));
+		out.push_back((uint8_t)((pcm >> 8) & 0xff));
+	}
+}
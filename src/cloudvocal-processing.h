@@ -2,11 +2,14 @@
 
 #include "cloudvocal-data.h"
 
+#include <vector>
+
 /**
  * @brief Extracts audio data from the buffer, resamples it, and updates timestamp offsets.
  *
- * This function extracts audio data from the input buffer, resamples it to 16kHz, and updates
- * gf->resampled_buffer with the resampled data.
+ * This function extracts audio data from the input buffer, converts it to mono at the session
+ * sample rate, and updates gf->resampled_buffer with the result. When the session runs at the
+ * input rate only the downmix is done and the resampler is skipped.
  *
  * @param gf Pointer to the transcription filter data structure.
  * @param start_timestamp_offset_ns Reference to the start timestamp offset in nanoseconds.
@@ -15,3 +18,16 @@
  */
 int get_data_from_buf_and_resample(cloudvocal_data *gf, uint64_t &start_timestamp_offset_ns,
 				   uint64_t &end_timestamp_offset_ns);
+
+/**
+ * @brief Encodes mono float samples for sending to a cloud provider.
+ *
+ * Samples are clamped to [-1, 1] and written as 16-bit little-endian PCM or 8-bit G.711
+ * mu-law, depending on the session encoding.
+ *
+ * @param samples Mono samples in the session sample rate.
+ * @param encoding The wire encoding.
+ * @param out Receives the encoded bytes. Its previous contents are replaced.
+ */
+void encode_audio_samples(const std::deque<float> &samples, AudioEncoding encoding,
+			  std::vector<uint8_t> &out);
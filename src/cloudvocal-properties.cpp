@@ -49,10 +49,13 @@ bool translation_cloud_options_callback(obs_properties_t *props, obs_property_t
 	const bool translate_enabled = obs_data_get_bool(settings, "translate_cloud");
 	for (const auto &prop :
 	     {"translate_cloud_provider", "translate_cloud_target_language",
-	      "translate_cloud_output", "translate_cloud_api_key",
-	      "translate_cloud_only_full_sentences", "translate_cloud_secret_key",
-	      "translate_cloud_deepl_free", "translate_cloud_region", "translate_cloud_endpoint",
-	      "translate_cloud_body", "translate_cloud_response_json_path"}) {
+	      "translate_cloud_output", "translate_cloud_extra_targets", "translate_cloud_api_key",
+	      "translate_cloud_only_full_sentences", "translate_cloud_partial_interval",
+	      "translate_cloud_incremental_partials", "translate_cloud_memory",
+	      "translate_cloud_secret_key", "translate_cloud_deepl_free", "translate_cloud_region",
+	      "translate_cloud_endpoint", "translate_cloud_body",
+	      "translate_cloud_response_json_path", "translate_cloud_fallbacks",
+	      "translate_cloud_rate_limit"}) {
 		obs_property_set_visible(obs_properties_get(props, prop), translate_enabled);
 	}
 	if (translate_enabled) {
@@ -148,8 +151,8 @@ void add_translation_cloud_group_properties(obs_properties_t *ppts)
 		translation_cloud_group, "translate_cloud_target_language", MT_("target_language"),
 		OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
 	// Populate the dropdown with the language codes
-	for (auto const &pair : language_codes_reverse) {
-		obs_property_list_add_string(prop_tgt, pair.first.c_str(), pair.second.c_str());
+	for (auto const &pair : language_names_sorted()) {
+		obs_property_list_add_string(prop_tgt, pair.first.data(), pair.second.data());
 	}
 	// add option for routing the translation to an output source
 	obs_property_t *prop_output = obs_properties_add_list(
@@ -158,10 +161,27 @@ void add_translation_cloud_group_properties(obs_properties_t *ppts)
 	obs_property_list_add_string(prop_output, "Write to captions output", "none");
 	obs_enum_sources(add_sources_to_list, prop_output);
 
+	// add list of further languages, translated together with the target language
+	obs_properties_add_editable_list(translation_cloud_group, "translate_cloud_extra_targets",
+					 MT_("translate_cloud_extra_targets"),
+					 OBS_EDITABLE_LIST_TYPE_STRINGS, NULL, NULL);
+
 	// add boolean option for only full sentences
 	obs_properties_add_bool(translation_cloud_group, "translate_cloud_only_full_sentences",
 				MT_("translate_cloud_only_full_sentences"));
 
+	// add slider for the minimum time between partial translations
+	obs_properties_add_int_slider(translation_cloud_group, "translate_cloud_partial_interval",
+				      MT_("translate_cloud_partial_interval"), 0, 3000, 50);
+
+	// add boolean option for translating partials clause by clause
+	obs_properties_add_bool(translation_cloud_group, "translate_cloud_incremental_partials",
+				MT_("translate_cloud_incremental_partials"));
+
+	// add boolean option for remembering translations across sessions
+	obs_properties_add_bool(translation_cloud_group, "translate_cloud_memory",
+				MT_("translate_cloud_memory"));
+
 	// add input for API Key
 	obs_properties_add_text(translation_cloud_group, "translate_cloud_api_key",
 				MT_("translate_cloud_api_key"), OBS_TEXT_DEFAULT);
@@ -186,6 +206,15 @@ void add_translation_cloud_group_properties(obs_properties_t *ppts)
 	// add input for json response path
 	obs_properties_add_text(translation_cloud_group, "translate_cloud_response_json_path",
 				MT_("translate_cloud_response_json_path"), OBS_TEXT_DEFAULT);
+
+	// add list of providers to fall back to when the selected one fails
+	obs_properties_add_editable_list(translation_cloud_group, "translate_cloud_fallbacks",
+					 MT_("translate_cloud_fallbacks"),
+					 OBS_EDITABLE_LIST_TYPE_STRINGS, NULL, NULL);
+
+	// add slider for the requests per second sent to each provider, 0 for no limit
+	obs_properties_add_int_slider(translation_cloud_group, "translate_cloud_rate_limit",
+				      MT_("translate_cloud_rate_limit"), 0, 50, 1);
 }
 
 void add_file_output_group_properties(obs_properties_t *ppts)
@@ -229,6 +258,18 @@ void add_advanced_group_properties(obs_properties_t *ppts, struct cloudvocal_dat
 				      MT_("min_sub_duration"), 1000, 5000, 50);
 	obs_properties_add_int_slider(advanced_config_group, "max_sub_duration",
 				      MT_("max_sub_duration"), 1000, 5000, 50);
+	obs_properties_add_int_slider(advanced_config_group, "caption_update_rate",
+				      MT_("caption_update_rate"), 0, 60, 1);
+	// add selection for the sample rate audio is sent to the provider at
+	obs_property_t *audio_bandwidth_list = obs_properties_add_list(
+		advanced_config_group, "audio_bandwidth_mode", MT_("audio_bandwidth_mode"),
+		OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(audio_bandwidth_list, MT_("audio_bandwidth_native"),
+				  AUDIO_BANDWIDTH_NATIVE);
+	obs_property_list_add_int(audio_bandwidth_list, MT_("audio_bandwidth_wideband"),
+				  AUDIO_BANDWIDTH_WIDEBAND);
+	obs_property_list_add_int(audio_bandwidth_list, MT_("audio_bandwidth_telephony"),
+				  AUDIO_BANDWIDTH_TELEPHONY);
 
 	// add button to open filter and replace UI dialog
 	// obs_properties_add_button2(
@@ -302,9 +343,9 @@ void add_general_group_properties(obs_properties_t *ppts)
 		general_group, "transcription_language_select", MT_("language"),
 		OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
 	// iterate over all available languages and add them to the list
-	for (auto const &pair : language_codes_reverse) {
-		obs_property_list_add_string(transcription_language_select_list, pair.first.c_str(),
-					     pair.second.c_str());
+	for (auto const &pair : language_names_sorted()) {
+		obs_property_list_add_string(transcription_language_select_list, pair.first.data(),
+					     pair.second.data());
 	}
 
 	// add text input for API Key
@@ -329,6 +370,10 @@ void add_partial_group_properties(obs_properties_t *ppts)
 	// add slider for partial latecy
 	obs_properties_add_int_slider(partial_group, "partial_latency", MT_("partial_latency"), 500,
 				      3000, 50);
+
+	// add slider for the stability that splits interim results into stable prefix and tail
+	obs_properties_add_float_slider(partial_group, "partial_stability",
+					MT_("partial_stability"), 0.0, 1.0, 0.05);
 }
 
 void add_timed_metadata_group_properties(obs_properties_t *ppts)
@@ -349,6 +394,9 @@ void add_timed_metadata_group_properties(obs_properties_t *ppts)
 	// add region
 	obs_properties_add_text(timed_metadata_group, "timed_metadata_aws_region",
 				MT_("timed_metadata_aws_region"), OBS_TEXT_DEFAULT);
+	// add slider for the PutMetadata requests per second, 0 for no limit
+	obs_properties_add_int_slider(timed_metadata_group, "timed_metadata_rate_limit",
+				      MT_("timed_metadata_rate_limit"), 0, 20, 1);
 }
 
 obs_properties_t *cloudvocal_properties(void *data)
@@ -398,15 +446,18 @@ void cloudvocal_defaults(obs_data_t *s)
 	obs_data_set_default_string(s, "transcription_cloud_provider", "clova");
 	obs_data_set_default_string(s, "subtitle_sources", "none");
 	obs_data_set_default_bool(s, "process_while_muted", false);
+	obs_data_set_default_int(s, "caption_update_rate", 0);
 	obs_data_set_default_bool(s, "subtitle_save_srt", false);
 	obs_data_set_default_bool(s, "truncate_output_file", false);
 	obs_data_set_default_bool(s, "only_while_recording", false);
 	obs_data_set_default_bool(s, "rename_file_to_match_recording", true);
 	obs_data_set_default_int(s, "min_sub_duration", 1000);
 	obs_data_set_default_int(s, "max_sub_duration", 3000);
+	obs_data_set_default_int(s, "audio_bandwidth_mode", AUDIO_BANDWIDTH_NATIVE);
 	obs_data_set_default_bool(s, "advanced_settings", false);
 	obs_data_set_default_bool(s, "partial_group", true);
 	obs_data_set_default_int(s, "partial_latency", 1100);
+	obs_data_set_default_double(s, "partial_stability", 0.5);
 
 	// cloud translation options
 	obs_data_set_default_bool(s, "translate_cloud", false);
@@ -414,6 +465,10 @@ void cloudvocal_defaults(obs_data_t *s)
 	obs_data_set_default_string(s, "translate_cloud_target_language", "__en__");
 	obs_data_set_default_string(s, "translate_cloud_output", "none");
 	obs_data_set_default_bool(s, "translate_cloud_only_full_sentences", true);
+	obs_data_set_default_int(s, "translate_cloud_partial_interval", 500);
+	obs_data_set_default_bool(s, "translate_cloud_incremental_partials", false);
+	obs_data_set_default_bool(s, "translate_cloud_memory", true);
+	obs_data_set_default_int(s, "translate_cloud_rate_limit", 10);
 	obs_data_set_default_string(s, "translate_cloud_api_key", "");
 	obs_data_set_default_string(s, "translate_cloud_secret_key", "");
 	obs_data_set_default_bool(s, "translate_cloud_deepl_free", true);
@@ -424,4 +479,7 @@ void cloudvocal_defaults(obs_data_t *s)
 		s, "translate_cloud_body",
 		"{\n\t\"text\":\"{{sentence}}\",\n\t\"target\":\"{{target_language}}\"\n}");
 	obs_data_set_default_string(s, "translate_cloud_response_json_path", "translations.0.text");
+
+	// timed metadata options, IVS allows 5 PutMetadata requests per second per channel
+	obs_data_set_default_int(s, "timed_metadata_rate_limit", 5);
 }
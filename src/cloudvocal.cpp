@@ -7,6 +7,8 @@
 #include <iomanip>
 #include <bitset>
 #include <regex>
+#include <string>
+#include <vector>
 #ifdef _WIN32
 #define NOMINMAX
 #include <Windows.h>
@@ -18,6 +20,7 @@
 #include "cloudvocal-callbacks.h"
 #include "cloudvocal-utils.h"
 #include "cloud-providers/cloud-provider.h"
+#include "timed-metadata/timed-metadata-utils.h"
 
 void set_source_signals(cloudvocal_data *gf, obs_source_t *parent_source)
 {
@@ -131,6 +134,12 @@ void cloudvocal_destroy(void *data)
 		gf->cloud_provider->stop();
 		gf->cloud_provider = nullptr;
 	}
+	// wait for translations that are still running, their callbacks use the filter data
+	gf->translation_group.close();
+	// captions still waiting are dropped, the text sources may be gone with the scene
+	gf->caption_mailbox.stop();
+	RateLimiter::instance().removeOwner(&gf->translate_cloud_config);
+	RateLimiter::instance().removeOwner(&gf->timed_metadata_config);
 
 	if (gf->resampler) {
 		audio_resampler_destroy(gf->resampler);
@@ -146,9 +155,90 @@ void cloudvocal_destroy(void *data)
 	gf->resampled_buffer.clear();
 	gf->context = nullptr;
 
+	gf->~cloudvocal_data();
 	bfree(gf);
 }
 
+// The strings of an editable list setting
+static std::vector<std::string> get_editable_list(obs_data_t *s, const char *name)
+{
+	std::vector<std::string> entries;
+	obs_data_array_t *array = obs_data_get_array(s, name);
+	for (size_t i = 0; i < obs_data_array_count(array); i++) {
+		obs_data_t *item = obs_data_array_item(array, i);
+		entries.push_back(obs_data_get_string(item, "value"));
+		obs_data_release(item);
+	}
+	obs_data_array_release(array);
+	return entries;
+}
+
+// Splits an editable list entry at ';', trimming each field
+static std::vector<std::string> split_list_entry(const std::string &entry)
+{
+	std::vector<std::string> fields;
+	std::stringstream stream(entry);
+	std::string field;
+	while (std::getline(stream, field, ';')) {
+		const size_t begin = field.find_first_not_of(" \t");
+		const size_t end = field.find_last_not_of(" \t");
+		fields.push_back(begin == std::string::npos ? ""
+							    : field.substr(begin, end - begin + 1));
+	}
+	return fields;
+}
+
+// Parses an extra translation target entry, "language;output source;file suffix;metadata".
+// Everything after the language is optional, metadata is 1 or true to send it.
+static bool parse_translation_target(const std::string &entry, TranslationTarget &target)
+{
+	const std::vector<std::string> fields = split_list_entry(entry);
+	if (fields.empty() || fields[0].empty()) {
+		return false;
+	}
+	// the same form as the target language list, so both share cached translations
+	target.language = fields[0].rfind("__", 0) == 0 ? fields[0] : "__" + fields[0] + "__";
+	target.output = fields.size() > 1 && fields[1] != "none" ? fields[1] : "";
+	target.file_suffix = fields.size() > 2 ? fields[2] : "";
+	target.metadata = fields.size() > 3 && (fields[3] == "1" || fields[3] == "true");
+	return true;
+}
+
+// Parses a fallback provider entry, "provider;api key;secret key;region;endpoint". Everything
+// after the provider is optional. A custom API fallback uses the body and response path of
+// the main settings, a DeepL key ending in ":fx" is for the free API.
+static bool parse_fallback_provider(const std::string &entry, const CloudTranslatorConfig &main,
+				    CloudTranslatorConfig &config)
+{
+	const std::vector<std::string> fields = split_list_entry(entry);
+	if (fields.empty() || !getTranslatorCapabilities(fields[0])) {
+		return false;
+	}
+	config.provider = fields[0];
+	config.access_key = fields.size() > 1 ? fields[1] : "";
+	config.secret_key = fields.size() > 2 ? fields[2] : "";
+	config.region = fields.size() > 3 ? fields[3] : "";
+	config.endpoint = fields.size() > 4 ? fields[4] : "";
+	config.free = config.access_key.size() > 3 &&
+		      config.access_key.compare(config.access_key.size() - 3, 3, ":fx") == 0;
+	config.body = main.body;
+	config.response_json_path = main.response_json_path;
+	return true;
+}
+
+// Time between caption pushes to a text source, one video frame when the rate is 0
+static std::chrono::microseconds caption_update_interval(int64_t updates_per_second)
+{
+	if (updates_per_second > 0) {
+		return std::chrono::microseconds(1000000 / updates_per_second);
+	}
+	struct obs_video_info ovi;
+	if (obs_get_video_info(&ovi) && ovi.fps_num > 0) {
+		return std::chrono::microseconds((int64_t)1000000 * ovi.fps_den / ovi.fps_num);
+	}
+	return std::chrono::microseconds(0);
+}
+
 void cloudvocal_update(void *data, obs_data_t *s)
 {
 	struct cloudvocal_data *gf = static_cast<struct cloudvocal_data *>(data);
@@ -169,15 +259,35 @@ void cloudvocal_update(void *data, obs_data_t *s)
 	gf->min_sub_duration = (int)obs_data_get_int(s, "min_sub_duration");
 	gf->max_sub_duration = (int)obs_data_get_int(s, "max_sub_duration");
 	gf->last_sub_render_time = now_ms();
+	// the frame rate is read here, a change to it applies from the next update
+	gf->caption_mailbox.setInterval(
+		caption_update_interval(obs_data_get_int(s, "caption_update_rate")));
+	// interim results are requested from the provider when its session starts
+	const bool new_partial_transcription = obs_data_get_bool(s, "partial_group");
+	const bool partial_transcription_changed =
+		gf->partial_transcription != new_partial_transcription;
+	gf->partial_transcription = new_partial_transcription;
+	const AudioBandwidthMode new_audio_bandwidth_mode =
+		(AudioBandwidthMode)obs_data_get_int(s, "audio_bandwidth_mode");
+	const bool audio_bandwidth_mode_changed =
+		gf->audio_bandwidth_mode != new_audio_bandwidth_mode;
+	gf->audio_bandwidth_mode = new_audio_bandwidth_mode;
+	gf->partial_stability_threshold = (float)obs_data_get_double(s, "partial_stability");
 	const char *filter_words_replace = obs_data_get_string(s, "filter_words_replace");
 	if (filter_words_replace != nullptr && strlen(filter_words_replace) > 0) {
 		obs_log(gf->log_level, "filter_words_replace: %s", filter_words_replace);
 		// deserialize the filter words replace
-		// gf->filter_words_replace = deserialize_filter_words_replace(filter_words_replace);
+		gf->filter_words_replace = deserialize_filter_words_replace(filter_words_replace);
 	} else {
 		// clear the filter words replace
 		gf->filter_words_replace.clear();
 	}
+	// compiled here once, not for every caption
+	std::shared_ptr<const WordFilter> word_filter;
+	if (!gf->filter_words_replace.empty()) {
+		word_filter = std::make_shared<const WordFilter>(gf->filter_words_replace);
+	}
+	std::atomic_store(&gf->word_filter, word_filter);
 
 	if (gf->save_to_file) {
 		gf->output_file_path = "";
@@ -196,6 +306,10 @@ void cloudvocal_update(void *data, obs_data_t *s)
 	gf->translation_output = obs_data_get_string(s, "translate_cloud_output");
 	gf->translate_only_full_sentences =
 		obs_data_get_bool(s, "translate_cloud_only_full_sentences");
+	gf->translation_group.setMinPartialInterval(std::chrono::milliseconds(
+		obs_data_get_int(s, "translate_cloud_partial_interval")));
+	gf->translation_memory = obs_data_get_bool(s, "translate_cloud_memory");
+	gf->incremental_partials = obs_data_get_bool(s, "translate_cloud_incremental_partials");
 	gf->translate_cloud_config.access_key = obs_data_get_string(s, "translate_cloud_api_key");
 	gf->translate_cloud_config.secret_key =
 		obs_data_get_string(s, "translate_cloud_secret_key");
@@ -205,6 +319,33 @@ void cloudvocal_update(void *data, obs_data_t *s)
 	gf->translate_cloud_config.body = obs_data_get_string(s, "translate_cloud_body");
 	gf->translate_cloud_config.response_json_path =
 		obs_data_get_string(s, "translate_cloud_response_json_path");
+	gf->translate_cloud_config.fallbacks.clear();
+	for (const std::string &entry : get_editable_list(s, "translate_cloud_fallbacks")) {
+		CloudTranslatorConfig fallback;
+		if (parse_fallback_provider(entry, gf->translate_cloud_config, fallback)) {
+			gf->translate_cloud_config.fallbacks.push_back(fallback);
+		} else {
+			// the entry holds credentials, only the provider is logged
+			obs_log(LOG_WARNING, "Ignoring fallback translation provider '%s'",
+				entry.substr(0, entry.find(';')).c_str());
+		}
+	}
+	// each filter's settings are owners of their own limit, shared buckets take the lowest
+	set_translation_rate_limit(&gf->translate_cloud_config, gf->translate_cloud_config,
+				   (double)obs_data_get_int(s, "translate_cloud_rate_limit"));
+
+	// the target language from the settings first, then the extra targets
+	std::vector<TranslationTarget> translation_targets = {
+		{gf->target_lang, gf->translation_output, "", true}};
+	for (const std::string &entry : get_editable_list(s, "translate_cloud_extra_targets")) {
+		TranslationTarget target;
+		if (parse_translation_target(entry, target)) {
+			translation_targets.push_back(target);
+		} else {
+			obs_log(LOG_WARNING, "Ignoring translation target '%s'", entry.c_str());
+		}
+	}
+	gf->translation_targets = translation_targets;
 
 	obs_log(gf->log_level, "update text source");
 	// update the text source
@@ -231,9 +372,11 @@ void cloudvocal_update(void *data, obs_data_t *s)
 	if (gf->cloud_provider_selection != new_cloud_provider_selection ||
 	    gf->language != new_language ||
 	    gf->cloud_provider_api_key != new_cloud_provider_api_key ||
-	    gf->cloud_provider_secret_key != new_cloud_provider_secret_key) {
-		// cloud provider selection or api key changed
-		obs_log(gf->log_level, "cloud provider selection, language or keys changed");
+	    gf->cloud_provider_secret_key != new_cloud_provider_secret_key ||
+	    partial_transcription_changed || audio_bandwidth_mode_changed) {
+		// cloud provider selection, api key or session options changed
+		obs_log(gf->log_level,
+			"cloud provider selection, language, keys or session options changed");
 		gf->cloud_provider_selection = new_cloud_provider_selection;
 		gf->language = new_language;
 		gf->cloud_provider_api_key = new_cloud_provider_api_key;
@@ -252,6 +395,8 @@ void cloudvocal_update(void *data, obs_data_t *s)
 	gf->timed_metadata_config.ivs_channel_arn =
 		obs_data_get_string(s, "timed_metadata_channel_arn");
 	gf->timed_metadata_config.aws_region = obs_data_get_string(s, "timed_metadata_aws_region");
+	set_timed_metadata_rate_limit(&gf->timed_metadata_config, gf->timed_metadata_config,
+				      (double)obs_data_get_int(s, "timed_metadata_rate_limit"));
 
 	if (gf->context != nullptr && (obs_source_enabled(gf->context) || gf->initial_creation)) {
 		if (gf->initial_creation) {
@@ -299,22 +444,8 @@ void *cloudvocal_create(obs_data_t *settings, obs_source_t *filter)
 
 	obs_log(gf->log_level, "channels %d, sample_rate %d", (int)gf->channels, gf->sample_rate);
 
-	obs_log(gf->log_level, "setup audio resampler");
-	struct resample_info src, dst;
-	src.samples_per_sec = gf->sample_rate;
-	src.format = AUDIO_FORMAT_FLOAT_PLANAR;
-	src.speakers = convert_speaker_layout((uint8_t)gf->channels);
-
-	dst.samples_per_sec = TRANSCRIPTION_SAMPLE_RATE;
-	dst.format = AUDIO_FORMAT_FLOAT_PLANAR;
-	dst.speakers = convert_speaker_layout((uint8_t)1);
-
-	gf->resampler = audio_resampler_create(&dst, &src);
-	if (!gf->resampler) {
-		obs_log(LOG_ERROR, "Failed to create resampler");
-		gf->active = false;
-		return nullptr;
-	}
+	// the resampler is created per provider session, for the rate the provider is sent
+	gf->resampler = nullptr;
 
 	obs_log(gf->log_level, "clear text source data");
 	const char *subtitle_sources = obs_data_get_string(settings, "subtitle_sources");
@@ -333,12 +464,18 @@ void *cloudvocal_create(obs_data_t *settings, obs_source_t *filter)
 	signal_handler_t *sh_filter = obs_source_get_signal_handler(gf->context);
 	if (sh_filter == nullptr) {
 		obs_log(LOG_ERROR, "Failed to get signal handler");
-		gf->active = false;
+		// nothing is started yet, releasing the data also releases the HTTP engine
+		gf->~cloudvocal_data();
+		bfree(gf);
 		return nullptr;
 	}
 
 	signal_handler_connect(sh_filter, "enable", enable_callback, gf);
 
+	gf->caption_mailbox.start([gf](const std::string &output, const std::string &caption) {
+		update_caption_source(output, caption, gf);
+	});
+
 	obs_log(gf->log_level, "run update");
 	// get the settings updated on the filter data struct
 	cloudvocal_update(gf, settings);
@@ -1,57 +1,55 @@
 #ifndef LANGUAGE_CODES_H
 #define LANGUAGE_CODES_H
 
-#include <map>
 #include <string>
+#include <string_view>
 
-extern std::map<std::string, std::string> language_codes;
-extern std::map<std::string, std::string> language_codes_reverse;
-extern std::map<std::string, std::string> language_codes_to_underscore;
-extern std::map<std::string, std::string> language_codes_from_underscore;
-extern std::map<std::string, std::string> language_codes_to_locale;
+#include "utils/perfect-hash.h"
+
+// The language tables are immutable and built at compile time, so these lookups never
+// allocate and are safe to call from any thread. Unknown codes return an empty string_view.
+// Returned views point into string literals and are null-terminated.
+std::string_view language_code_name(std::string_view code);            // "__en__" -> "English"
+std::string_view language_code_to_underscore(std::string_view code);   // "en" -> "__en__"
+std::string_view language_code_from_underscore(std::string_view code); // "__en__" -> "en"
+std::string_view language_code_to_locale(std::string_view code);       // "en" -> "en-US"
+
+// (language name, "__xx__" code) pairs sorted by name, for populating language lists
+struct LanguageNameList {
+	const perfect_hash::StringPair *first;
+	const perfect_hash::StringPair *last;
+
+	const perfect_hash::StringPair *begin() const { return first; }
+	const perfect_hash::StringPair *end() const { return last; }
+};
+LanguageNameList language_names_sorted();
 
 inline bool isLanguageSupported(const std::string &lang_code)
 {
-	return language_codes.find(lang_code) != language_codes.end() ||
-	       language_codes_to_underscore.find(lang_code) != language_codes_to_underscore.end();
+	return !language_code_name(lang_code).empty() ||
+	       !language_code_to_underscore(lang_code).empty();
 }
 
 inline std::string getLanguageName(const std::string &lang_code)
 {
-	auto it = language_codes.find(lang_code);
-	if (it != language_codes.end()) {
-		return it->second;
+	std::string_view name = language_code_name(lang_code);
+	if (name.empty()) {
+		// check if it's a underscore language code
+		name = language_code_name(language_code_to_underscore(lang_code));
 	}
-	// check if it's a underscore language code
-	it = language_codes_to_underscore.find(lang_code);
-	if (it != language_codes_to_underscore.end()) {
-		// convert to the language code
-		const std::string &underscore_code = it->second;
-		it = language_codes.find(underscore_code);
-		if (it != language_codes.end()) {
-			return it->second;
-		}
-	}
-	return lang_code; // Return the code itself if no mapping exists
+	// Return the code itself if no mapping exists
+	return name.empty() ? lang_code : std::string(name);
 }
 
 inline std::string getLanguageLocale(const std::string &lang_code)
 {
-	auto it = language_codes_to_locale.find(lang_code);
-	if (it != language_codes_to_locale.end()) {
-		return it->second;
-	}
-	// check if it's a underscore language code
-	it = language_codes_from_underscore.find(lang_code);
-	if (it != language_codes_from_underscore.end()) {
-		// convert to the language code
-		const std::string &language_code = it->second;
-		it = language_codes_to_locale.find(language_code);
-		if (it != language_codes_to_locale.end()) {
-			return it->second;
-		}
+	std::string_view locale = language_code_to_locale(lang_code);
+	if (locale.empty()) {
+		// check if it's a underscore language code
+		locale = language_code_to_locale(language_code_from_underscore(lang_code));
 	}
-	return lang_code; // Return the code itself if no mapping exists
+	// Return the code itself if no mapping exists
+	return locale.empty() ? lang_code : std::string(locale);
 }
 
 #endif // LANGUAGE_CODES_H
@@ -1,6 +1,7 @@
 
 #include "plugin-support.h"
 #include "timed-metadata-utils.h"
+#include "utils/curl-helper.h"
 #include "utils/ssl-utils.h"
 
 #include <openssl/evp.h>
@@ -16,16 +17,20 @@
 #include <ctime>
 #include <thread>
 
-#include <curl/curl.h>
-
 #include <obs-module.h>
 
 #include <nlohmann/json.hpp>
 
-size_t WriteCallback(void *ptr, size_t size, size_t nmemb, std::string *data)
+// IVS limits PutMetadata per channel
+static std::string rate_key(const TimedMetadataConfig &config)
+{
+	return RateLimiter::makeKey("ivs", config.ivs_channel_arn);
+}
+
+void set_timed_metadata_rate_limit(const void *owner, const TimedMetadataConfig &config,
+				   double per_second)
 {
-	data->append((char *)ptr, size * nmemb);
-	return size * nmemb;
+	RateLimiter::instance().setRate(owner, {rate_key(config)}, per_second);
 }
 
 void send_timed_metadata_to_ivs_endpoint(struct cloudvocal_data *gf, Translation_Mode mode,
@@ -131,52 +136,34 @@ void send_timed_metadata_to_ivs_endpoint(struct cloudvocal_data *gf, Translation
 
 	std::string AUTH_HEADER = authHeader.str();
 
-	// Initialize CURL and set options
-	CURL *curl;
-	CURLcode res;
-	curl = curl_easy_init();
-	if (!curl) {
-		obs_log(LOG_ERROR,
-			"send_timed_metadata_to_ivs_endpoint failed: curl_easy_init failed");
-		return;
-	}
-
-	curl_easy_setopt(curl, CURLOPT_URL, ("https://" + HOST + "/PutMetadata").c_str());
-	struct curl_slist *headers = NULL;
-	headers = curl_slist_append(headers, "Content-Type: application/json");
-	headers = curl_slist_append(headers, ("Host: " + HOST).c_str());
-	headers = curl_slist_append(headers, ("x-amz-date: " + TIMESTAMP).c_str());
-	headers = curl_slist_append(headers, ("Authorization: " + AUTH_HEADER).c_str());
-	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-	curl_easy_setopt(curl, CURLOPT_POSTFIELDS, METADATA.c_str());
-
-	std::string response_string;
-	std::string header_string;
-	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_string);
-	curl_easy_setopt(curl, CURLOPT_HEADERDATA, &header_string);
-
-	res = curl_easy_perform(curl);
-	if (res != CURLE_OK) {
-		obs_log(LOG_WARNING, "send_timed_metadata_to_ivs_endpoint failed:%s",
-			curl_easy_strerror(res));
-	} else {
-		long response_code;
-		// Get the HTTP response code
-		curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-		obs_log(gf->log_level, "HTTP Status code: %ld", response_code);
-		if (response_code != 204) {
-			obs_log(LOG_WARNING, "HTTP response: %s", response_string.c_str());
+	HttpRequest request;
+	request.url = "https://" + HOST + "/PutMetadata";
+	request.post = true;
+	request.body = METADATA;
+	request.headers = {"Content-Type: application/json", "Host: " + HOST,
+			   "x-amz-date: " + TIMESTAMP, "Authorization: " + AUTH_HEADER};
+
+	// the response arrives on the engine thread, possibly after the filter is gone
+	const int log_level = gf->log_level;
+	auto on_done = [log_level](const HttpResponse &response) {
+		if (response.result != CURLE_OK) {
+			obs_log(LOG_WARNING, "send_timed_metadata_to_ivs_endpoint failed:%s",
+				curl_easy_strerror(response.result));
+			return;
 		}
-	}
-	curl_slist_free_all(headers);
-	curl_easy_cleanup(curl);
+		obs_log(log_level, "HTTP Status code: %ld", response.status_code);
+		if (response.status_code != 204) {
+			obs_log(LOG_WARNING, "HTTP response: %s", response.body.c_str());
+		}
+	};
+	CurlHelper::performAsync(std::move(request), on_done);
 }
 
 // source: transcription text, target: translation text
 void send_timed_metadata_to_server(struct cloudvocal_data *gf, Translation_Mode mode,
 				   const std::string &source_text, const std::string &source_lang,
-				   const std::string &target_text, const std::string &target_lang)
+				   const std::string &target_text, const std::string &target_lang,
+				   RequestPriority priority)
 {
 	if (!gf->send_timed_metadata) {
 		obs_log(gf->log_level,
@@ -193,6 +180,11 @@ void send_timed_metadata_to_server(struct cloudvocal_data *gf, Translation_Mode
 	}
 
 	std::thread send_timed_metadata_thread([=]() {
+		// finals wait for their turn here, partials are dropped
+		if (!RateLimiter::instance().acquire(rate_key(gf->timed_metadata_config),
+						     priority)) {
+			return;
+		}
 		send_timed_metadata_to_ivs_endpoint(gf, mode, source_text, source_lang, target_text,
 						    target_lang);
 	});
@@ -5,11 +5,18 @@
 #include <vector>
 
 #include "cloudvocal-data.h"
+#include "utils/rate-limiter.h"
 
 enum Translation_Mode { ONLY_TARGET, SOURCE_AND_TARGET, ONLY_SOURCE };
 
 void send_timed_metadata_to_server(struct cloudvocal_data *gf, Translation_Mode mode,
 				   const std::string &source_text, const std::string &source_lang,
-				   const std::string &target_text, const std::string &target_lang);
+				   const std::string &target_text, const std::string &target_lang,
+				   RequestPriority priority = REQUEST_PRIORITY_FINAL);
+
+// Limits the PutMetadata requests to the channel, in requests per second. 0 removes the limit
+// owner set. Where several owners limit the same channel, the lowest rate applies.
+void set_timed_metadata_rate_limit(const void *owner, const TimedMetadataConfig &config,
+				   double per_second);
 
 #endif // TIMED_METADATA_UTILS_H
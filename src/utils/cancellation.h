@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Cooperative cancellation of blocking work. The thread doing the work installs a flag with a
+// CancellationScope, anything it calls (e.g. a curl transfer) can poll
+// CancellationScope::cancelled() and give up early once another thread sets the flag.
+typedef std::shared_ptr<std::atomic<bool>> CancellationFlag;
+// Work cancelled by any of several flags, e.g. its caller's and its own
+typedef std::vector<CancellationFlag> CancellationFlags;
+
+inline CancellationFlag make_cancellation_flag()
+{
+	return std::make_shared<std::atomic<bool>>(false);
+}
+
+inline bool any_cancelled(const CancellationFlags &flags)
+{
+	for (const CancellationFlag &flag : flags) {
+		if (flag && flag->load()) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// The scopes replace each other rather than nest: work in the innermost scope is cancelled by
+// its flags only. A scope with no flag shields work from its caller's cancellation.
+class CancellationScope {
+public:
+	explicit CancellationScope(CancellationFlag flag) : previous_(current())
+	{
+		current().clear();
+		if (flag) {
+			current().push_back(std::move(flag));
+		}
+	}
+	explicit CancellationScope(CancellationFlags flags) : previous_(current())
+	{
+		current() = std::move(flags);
+	}
+	~CancellationScope() { current() = std::move(previous_); }
+	CancellationScope(const CancellationScope &) = delete;
+	CancellationScope &operator=(const CancellationScope &) = delete;
+
+	// True if a flag of the innermost scope on this thread has been set
+	static bool cancelled() { return any_cancelled(current()); }
+
+	// The flags of the innermost scope on this thread, to carry them over to other threads,
+	// or to add a flag of one's own
+	static CancellationFlags flags() { return current(); }
+
+private:
+	static CancellationFlags &current()
+	{
+		static thread_local CancellationFlags flags;
+		return flags;
+	}
+
+	CancellationFlags previous_;
+};
@@ -0,0 +1,96 @@
+#include "caption-mailbox.h"
+
+#include <utility>
+
+#include <obs-module.h>
+#include "plugin-support.h"
+
+CaptionMailbox::~CaptionMailbox()
+{
+	stop();
+}
+
+void CaptionMailbox::start(Sink sink)
+{
+	stop();
+	std::lock_guard<std::mutex> lock(mutex_);
+	pending_.clear();
+	sink_ = std::move(sink);
+	running_ = true;
+	thread_ = std::thread(&CaptionMailbox::run, this);
+}
+
+void CaptionMailbox::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!running_) {
+			return;
+		}
+		running_ = false;
+		pending_.clear();
+		cv_.notify_all();
+	}
+	thread_.join();
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	sink_ = nullptr;
+	obs_log(LOG_INFO, "Caption mailbox stopped: %llu posted, %llu pushed, %llu coalesced",
+		(unsigned long long)metrics_.posted, (unsigned long long)metrics_.pushed,
+		(unsigned long long)metrics_.coalesced);
+}
+
+void CaptionMailbox::setInterval(std::chrono::microseconds interval)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	interval_ = interval;
+	cv_.notify_all();
+}
+
+void CaptionMailbox::post(const std::string &output, const std::string &caption)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (!running_) {
+		return;
+	}
+	metrics_.posted++;
+	auto inserted = pending_.emplace(output, caption);
+	if (!inserted.second) {
+		inserted.first->second = caption;
+		metrics_.coalesced++;
+		return;
+	}
+	cv_.notify_all();
+}
+
+CaptionMailbox::Metrics CaptionMailbox::metrics()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return metrics_;
+}
+
+void CaptionMailbox::run()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	for (;;) {
+		cv_.wait(lock, [this] { return !running_ || !pending_.empty(); });
+		// captions posted while waiting out the interval replace the pending ones
+		while (running_ && std::chrono::steady_clock::now() < last_push_ + interval_) {
+			cv_.wait_until(lock, last_push_ + interval_);
+		}
+		if (!running_) {
+			return;
+		}
+
+		std::unordered_map<std::string, std::string> captions;
+		captions.swap(pending_);
+		last_push_ = std::chrono::steady_clock::now();
+		metrics_.pushed += captions.size();
+		lock.unlock();
+		// the sink is only replaced while the thread is stopped
+		for (const auto &caption : captions) {
+			sink_(caption.first, caption.second);
+		}
+		lock.lock();
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// Holds the latest caption for each output and pushes it from its own thread, at most once
+// per interval. Text sources lay out and rasterize their text on every update, and partials
+// can arrive faster than frames are drawn, so a caption replaced before the next push is
+// never sent. A caption arriving after a quiet interval is pushed right away.
+class CaptionMailbox {
+public:
+	using Sink = std::function<void(const std::string &output, const std::string &caption)>;
+
+	struct Metrics {
+		uint64_t posted = 0;    // captions handed to the mailbox
+		uint64_t pushed = 0;    // captions passed to the sink
+		uint64_t coalesced = 0; // captions replaced before they were pushed
+	};
+
+	CaptionMailbox() = default;
+	~CaptionMailbox();
+
+	CaptionMailbox(const CaptionMailbox &) = delete;
+	CaptionMailbox &operator=(const CaptionMailbox &) = delete;
+
+	// Starts the thread calling sink. Captions posted before are dropped.
+	void start(Sink sink);
+	// Stops the thread once a push in progress returns, dropping the captions still waiting
+	void stop();
+
+	// Minimum time between pushes, 0 to push every caption as it comes
+	void setInterval(std::chrono::microseconds interval);
+
+	// Replaces the caption waiting for output
+	void post(const std::string &output, const std::string &caption);
+
+	Metrics metrics();
+
+private:
+	void run();
+
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	std::unordered_map<std::string, std::string> pending_;
+	std::chrono::microseconds interval_{0};
+	std::chrono::steady_clock::time_point last_push_;
+	bool running_ = false;
+	Sink sink_;
+	std::thread thread_;
+	Metrics metrics_;
+};
@@ -1,11 +1,78 @@
 #include "curl-helper.h"
+#include "cancellation.h"
+#include "http-engine.h"
+#include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <memory>
+#include <stdexcept>
 
 bool CurlHelper::is_initialized_ = false;
 std::mutex CurlHelper::curl_mutex_;
 
-CurlHelper::CurlHelper()
+namespace {
+
+// Idle handles kept for reuse. More concurrent requests than this still work, the extra
+// handles are cleaned up instead of being pooled.
+const size_t MAX_POOLED_HANDLES = 8;
+
+std::mutex pool_mutex;
+std::vector<CURL *> idle_handles;
+
+std::mutex share_mutexes[CURL_LOCK_DATA_LAST];
+
+void share_lock(CURL *, curl_lock_data data, curl_lock_access, void *)
+{
+	share_mutexes[data].lock();
+}
+
+void share_unlock(CURL *, curl_lock_data data, void *)
+{
+	share_mutexes[data].unlock();
+}
+
+// Process-wide connection, DNS and TLS session caches shared by all pooled handles
+CURLSH *shared_caches()
+{
+	static CURLSH *share = [] {
+		CURLSH *sh = curl_share_init();
+		curl_share_setopt(sh, CURLSHOPT_LOCKFUNC, share_lock);
+		curl_share_setopt(sh, CURLSHOPT_UNLOCKFUNC, share_unlock);
+		curl_share_setopt(sh, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+		curl_share_setopt(sh, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+		curl_share_setopt(sh, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+		return sh;
+	}();
+	return share;
+}
+
+void set_default_options(CURL *curl)
+{
+	curl_easy_setopt(curl, CURLOPT_SHARE, shared_caches());
+	curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+	// HTTP/2 where the server and the curl build support it, HTTP/1.1 otherwise
+	curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+	// keep idle connections from being dropped by NATs between captions
+	curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+	curl_easy_setopt(curl, CURLOPT_TCP_KEEPIDLE, 30L);
+	curl_easy_setopt(curl, CURLOPT_TCP_KEEPINTVL, 15L);
+	curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+	curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+}
+
+// A request handed to the engine, and the pieces of its body not yet passed to on_data
+struct PendingRequest {
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::deque<std::string> pieces;
+	bool write_failed = false; // on_data threw, the transfer fails with its next piece
+	bool done = false;
+	HttpResponse response;
+};
+
+} // namespace
+
+void CurlHelper::initialize()
 {
 	std::lock_guard<std::mutex> lock(curl_mutex_);
 	if (!is_initialized_) {
@@ -16,12 +83,130 @@ CurlHelper::CurlHelper()
 	}
 }
 
+CurlHelper::CurlHelper()
+{
+	initialize();
+}
+
 CurlHelper::~CurlHelper()
 {
 	// Don't call curl_global_cleanup() in destructor
 	// Let it clean up when the program exits
 }
 
+CurlHelper::Handle::Handle() : curl_(nullptr)
+{
+	initialize();
+	{
+		std::lock_guard<std::mutex> lock(pool_mutex);
+		if (!idle_handles.empty()) {
+			curl_ = idle_handles.back();
+			idle_handles.pop_back();
+		}
+	}
+	if (!curl_) {
+		curl_ = curl_easy_init();
+	}
+	if (curl_) {
+		set_default_options(curl_);
+	}
+}
+
+CurlHelper::Handle::~Handle()
+{
+	if (!curl_) {
+		return;
+	}
+	// reset clears the options of the last request but keeps the handle's caches
+	curl_easy_reset(curl_);
+	std::lock_guard<std::mutex> lock(pool_mutex);
+	if (idle_handles.size() < MAX_POOLED_HANDLES) {
+		idle_handles.push_back(curl_);
+	} else {
+		curl_easy_cleanup(curl_);
+	}
+}
+
+HttpResponse CurlHelper::perform(const HttpRequest &request)
+{
+	if (CancellationScope::cancelled()) {
+		HttpResponse response;
+		response.result = CURLE_ABORTED_BY_CALLBACK;
+		return response;
+	}
+
+	// the engine runs the transfer and aborts it once this thread's scope is cancelled. This
+	// thread sleeps until a piece of the body or the response arrives, and passes the pieces
+	// to on_data.
+	auto pending = std::make_shared<PendingRequest>();
+	HttpRequest engine_request = request;
+	if (request.on_data) {
+		engine_request.on_data = [pending](const char *data, size_t size) {
+			std::lock_guard<std::mutex> lock(pending->mutex);
+			if (pending->write_failed) {
+				// the engine fails the transfer with CURLE_WRITE_ERROR
+				throw std::runtime_error("response body rejected");
+			}
+			pending->pieces.emplace_back(data, size);
+			pending->cv.notify_all();
+		};
+	}
+	HttpEngine::instance().submit(
+		std::move(engine_request),
+		[pending](const HttpResponse &response) {
+			std::lock_guard<std::mutex> lock(pending->mutex);
+			pending->response = response;
+			pending->done = true;
+			pending->cv.notify_all();
+		},
+		CancellationScope::flags());
+
+	bool write_failed = false;
+	std::unique_lock<std::mutex> lock(pending->mutex);
+	for (;;) {
+		pending->cv.wait(lock,
+				 [&pending] { return pending->done || !pending->pieces.empty(); });
+		std::deque<std::string> pieces;
+		pieces.swap(pending->pieces);
+		const bool done = pending->done;
+		lock.unlock();
+		for (const std::string &piece : pieces) {
+			try {
+				if (!write_failed) {
+					request.on_data(piece.data(), piece.size());
+				}
+			} catch (const std::exception &) {
+				write_failed = true;
+			}
+		}
+		lock.lock();
+		if (done) {
+			break;
+		}
+		pending->write_failed = write_failed;
+	}
+
+	HttpResponse response = std::move(pending->response);
+	if (write_failed) {
+		response.result = CURLE_WRITE_ERROR;
+	}
+	return response;
+}
+
+void CurlHelper::performAsync(HttpRequest request,
+			      std::function<void(const HttpResponse &response)> on_done)
+{
+	if (CancellationScope::cancelled()) {
+		HttpResponse response;
+		response.result = CURLE_ABORTED_BY_CALLBACK;
+		on_done(response);
+		return;
+	}
+	initialize();
+	HttpEngine::instance().submit(std::move(request), std::move(on_done),
+				      CancellationScope::flags());
+}
+
 size_t CurlHelper::WriteCallback(void *contents, size_t size, size_t nmemb, void *userp)
 {
 	if (!userp) {
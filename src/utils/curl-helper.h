@@ -1,14 +1,87 @@
 #pragma once
+#include <functional>
 #include <string>
 #include <mutex>
+#include <vector>
 
 #include <curl/curl.h>
 
+struct HttpRequest {
+	std::string url;
+	std::vector<std::string> headers;
+	bool post = false;
+	std::string body; // POST body
+	long timeout_ms = 30000;
+	// Called with each piece of the body as it arrives, e.g. for server-sent events. The
+	// response body is collected as well.
+	std::function<void(const char *data, size_t size)> on_data;
+};
+
+struct HttpResponse {
+	CURLcode result = CURLE_OK; // transport result, the status code is only valid on CURLE_OK
+	long status_code = 0;
+	std::string body;
+};
+
+// Caps the timeout of the requests made on this thread while it is in scope, for callers
+// that choose the timeout of requests a translator makes on their behalf
+class RequestTimeoutScope {
+public:
+	explicit RequestTimeoutScope(long timeout_ms) : previous_(current())
+	{
+		current() = timeout_ms;
+	}
+	~RequestTimeoutScope() { current() = previous_; }
+	RequestTimeoutScope(const RequestTimeoutScope &) = delete;
+	RequestTimeoutScope &operator=(const RequestTimeoutScope &) = delete;
+
+	// The timeout of the innermost scope on this thread, 0 if there is none
+	static long timeout() { return current(); }
+
+private:
+	static long &current()
+	{
+		static thread_local long timeout_ms = 0;
+		return timeout_ms;
+	}
+
+	long previous_;
+};
+
 class CurlHelper {
 public:
 	CurlHelper();
 	~CurlHelper();
 
+	// A pooled easy handle, returned to the pool when the lease goes out of scope. Pooled
+	// handles share one connection cache, DNS cache and TLS session cache, so a request to
+	// a host that was used recently skips the TCP and TLS handshakes.
+	class Handle {
+	public:
+		Handle();
+		~Handle();
+		Handle(const Handle &) = delete;
+		Handle &operator=(const Handle &) = delete;
+
+		CURL *get() const { return curl_; }
+		explicit operator bool() const { return curl_ != nullptr; }
+
+	private:
+		CURL *curl_;
+	};
+
+	// Performs a request on the HttpEngine and waits for it; on_data is called on this
+	// thread. Transport errors are reported in the result rather than thrown. The transfer is
+	// aborted with CURLE_ABORTED_BY_CALLBACK when the calling thread's CancellationScope is
+	// cancelled. A RequestTimeoutScope shortens the request's timeout.
+	HttpResponse perform(const HttpRequest &request);
+
+	// Starts a request on the HttpEngine and returns right away, on_done runs on the engine
+	// thread once it is done, and must not block. The calling thread's CancellationScope and
+	// RequestTimeoutScope apply as with perform.
+	static void performAsync(HttpRequest request,
+				 std::function<void(const HttpResponse &response)> on_done);
+
 	// Callback for writing response data
 	static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *userp);
 
@@ -23,6 +96,9 @@ public:
 	static void setSSLVerification(CURL *curl, bool verify = true);
 
 private:
+	// curl_global_init, once per process
+	static void initialize();
+
 	static bool is_initialized_;
 	static std::mutex curl_mutex_; // For thread-safe global initialization
 };
@@ -0,0 +1,248 @@
+#include "http-engine.h"
+
+#include <algorithm>
+
+#include <obs-module.h>
+#include "plugin-support.h"
+
+// How long the engine thread sleeps while nothing happens on the sockets. Cancellation is
+// noticed at the latest after this while requests are running.
+static const int POLL_TIMEOUT_MS = 50;
+static const int IDLE_POLL_TIMEOUT_MS = 1000;
+
+struct HttpEngine::Transfer {
+	HttpRequest request;
+	HttpResponse response;
+	Callback on_done;
+	CancellationFlags cancel;
+	CurlHelper::Handle curl;
+	struct curl_slist *headers = nullptr;
+
+	~Transfer() { curl_slist_free_all(headers); }
+};
+
+size_t HttpEngine::writeCallback(void *contents, size_t size, size_t nmemb, void *userp)
+{
+	auto *transfer = static_cast<Transfer *>(userp);
+	const size_t realsize = size * nmemb;
+	try {
+		transfer->response.body.append(static_cast<char *>(contents), realsize);
+		if (transfer->request.on_data) {
+			transfer->request.on_data(static_cast<char *>(contents), realsize);
+		}
+		return realsize;
+	} catch (const std::exception &) {
+		return 0; // Return 0 to indicate error to libcurl
+	}
+}
+
+int HttpEngine::cancellationCallback(void *userp, curl_off_t, curl_off_t, curl_off_t,
+				     curl_off_t)
+{
+	auto *transfer = static_cast<Transfer *>(userp);
+	return any_cancelled(transfer->cancel) ? 1 : 0;
+}
+
+HttpEngine &HttpEngine::instance()
+{
+	static HttpEngine engine;
+	return engine;
+}
+
+HttpEngine::~HttpEngine()
+{
+	// every filter has released the engine by now, the thread is not joined here: static
+	// destructors may run under the loader lock
+	if (thread_.joinable()) {
+		thread_.detach();
+	}
+}
+
+void HttpEngine::retain()
+{
+	std::lock_guard<std::mutex> lifecycle_lock(lifecycle_mutex_);
+	if (users_++ > 0) {
+		return;
+	}
+	CURLM *multi = curl_multi_init();
+	// several requests to one host share a connection where the server speaks HTTP/2
+	curl_multi_setopt(multi, CURLMOPT_PIPELINING, (long)CURLPIPE_MULTIPLEX);
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		multi_ = multi;
+		running_ = true;
+	}
+	obs_log(LOG_INFO, "Starting the HTTP engine");
+	thread_ = std::thread(&HttpEngine::run, this);
+}
+
+void HttpEngine::release()
+{
+	std::lock_guard<std::mutex> lifecycle_lock(lifecycle_mutex_);
+	if (users_ == 0 || --users_ > 0) {
+		return;
+	}
+	CURLM *multi;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		running_ = false;
+		multi = multi_;
+		curl_multi_wakeup(multi);
+	}
+	thread_.join();
+	{
+		// submit only touches the handle while running_ is set
+		std::lock_guard<std::mutex> lock(mutex_);
+		multi_ = nullptr;
+	}
+	curl_multi_cleanup(multi);
+	obs_log(LOG_INFO, "HTTP engine stopped");
+}
+
+void HttpEngine::submit(HttpRequest request, Callback on_done, CancellationFlags cancel)
+{
+	auto transfer = std::make_unique<Transfer>();
+	transfer->request = std::move(request);
+	transfer->on_done = std::move(on_done);
+	transfer->cancel = std::move(cancel);
+
+	CURL *curl = transfer->curl.get();
+	if (!curl) {
+		transfer->response.result = CURLE_FAILED_INIT;
+		transfer->on_done(transfer->response);
+		return;
+	}
+	const HttpRequest &r = transfer->request;
+	for (const std::string &header : r.headers) {
+		transfer->headers = curl_slist_append(transfer->headers, header.c_str());
+	}
+	curl_easy_setopt(curl, CURLOPT_URL, r.url.c_str());
+	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+	curl_easy_setopt(curl, CURLOPT_WRITEDATA, transfer.get());
+	// the scope is read here, on the caller's thread
+	long timeout_ms = r.timeout_ms;
+	if (RequestTimeoutScope::timeout() > 0 && RequestTimeoutScope::timeout() < timeout_ms) {
+		timeout_ms = RequestTimeoutScope::timeout();
+	}
+	curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_ms);
+	curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, cancellationCallback);
+	curl_easy_setopt(curl, CURLOPT_XFERINFODATA, transfer.get());
+	curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+	if (transfer->headers) {
+		curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer->headers);
+	}
+	if (r.post) {
+		curl_easy_setopt(curl, CURLOPT_POST, 1L);
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, r.body.c_str());
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)r.body.size());
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (running_) {
+			queued_.push_back(std::move(transfer));
+			curl_multi_wakeup(multi_);
+			return;
+		}
+	}
+	// no filter is left to run the request for
+	complete(std::move(transfer), CURLE_ABORTED_BY_CALLBACK);
+}
+
+std::future<HttpResponse> HttpEngine::fetch(HttpRequest request, CancellationFlags cancel)
+{
+	auto promise = std::make_shared<std::promise<HttpResponse>>();
+	std::future<HttpResponse> future = promise->get_future();
+	submit(
+		std::move(request),
+		[promise](const HttpResponse &response) { promise->set_value(response); },
+		std::move(cancel));
+	return future;
+}
+
+void HttpEngine::complete(std::unique_ptr<Transfer> transfer, CURLcode result)
+{
+	transfer->response.result = result;
+	if (result == CURLE_OK) {
+		curl_easy_getinfo(transfer->curl.get(), CURLINFO_RESPONSE_CODE,
+				  &transfer->response.status_code);
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		metrics_.requests++;
+		if (result != CURLE_OK) {
+			metrics_.failed++;
+		}
+	}
+	try {
+		transfer->on_done(transfer->response);
+	} catch (const std::exception &e) {
+		obs_log(LOG_ERROR, "HTTP request callback failed: %s", e.what());
+	}
+	// the handle goes back to the pool with the transfer
+}
+
+void HttpEngine::run()
+{
+	for (;;) {
+		std::vector<std::unique_ptr<Transfer>> queued;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (!running_) {
+				break;
+			}
+			queued.swap(queued_);
+			metrics_.max_in_flight = std::max<uint64_t>(
+				metrics_.max_in_flight, active_.size() + queued.size());
+		}
+		for (std::unique_ptr<Transfer> &transfer : queued) {
+			CURL *curl = transfer->curl.get();
+			if (curl_multi_add_handle(multi_, curl) != CURLM_OK) {
+				complete(std::move(transfer), CURLE_FAILED_INIT);
+				continue;
+			}
+			active_[curl] = std::move(transfer);
+		}
+
+		int running = 0;
+		curl_multi_perform(multi_, &running);
+		int left = 0;
+		while (CURLMsg *message = curl_multi_info_read(multi_, &left)) {
+			if (message->msg != CURLMSG_DONE) {
+				continue;
+			}
+			auto it = active_.find(message->easy_handle);
+			if (it == active_.end()) {
+				continue;
+			}
+			std::unique_ptr<Transfer> transfer = std::move(it->second);
+			active_.erase(it);
+			curl_multi_remove_handle(multi_, message->easy_handle);
+			complete(std::move(transfer), message->data.result);
+		}
+
+		curl_multi_poll(multi_, nullptr, 0,
+				active_.empty() ? IDLE_POLL_TIMEOUT_MS : POLL_TIMEOUT_MS, nullptr);
+	}
+
+	// the last filter is gone, fail what is left
+	for (auto &entry : active_) {
+		curl_multi_remove_handle(multi_, entry.first);
+		complete(std::move(entry.second), CURLE_ABORTED_BY_CALLBACK);
+	}
+	active_.clear();
+	std::vector<std::unique_ptr<Transfer>> queued;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		queued.swap(queued_);
+	}
+	for (std::unique_ptr<Transfer> &transfer : queued) {
+		complete(std::move(transfer), CURLE_ABORTED_BY_CALLBACK);
+	}
+}
+
+HttpEngine::Metrics HttpEngine::metrics()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return metrics_;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "cancellation.h"
+#include "curl-helper.h"
+
+// Runs the HTTP requests of the plugin on one curl multi handle driven by a single thread.
+// Requests to the same host share the connection cache, HTTP/2 requests to it are
+// multiplexed over one connection, and a request in flight does not hold a thread. The thread
+// runs while a filter holds an HttpEngineUse, and is stopped with the last one, so none is
+// left when the module unloads.
+class HttpEngine {
+public:
+	typedef std::function<void(const HttpResponse &response)> Callback;
+
+	struct Metrics {
+		uint64_t requests = 0;
+		uint64_t failed = 0;       // transport errors, cancelled requests included
+		uint64_t max_in_flight = 0; // most requests running at the same time
+	};
+
+	static HttpEngine &instance();
+
+	~HttpEngine();
+	HttpEngine(const HttpEngine &) = delete;
+	HttpEngine &operator=(const HttpEngine &) = delete;
+
+	// Starts the request and returns right away. The transfer is aborted with
+	// CURLE_ABORTED_BY_CALLBACK once a flag of cancel is set, or when the engine stops.
+	// on_done, and request.on_data, run on the engine thread and must not block, the other
+	// requests wait for them. While the engine is stopped, on_done runs on the calling thread.
+	void submit(HttpRequest request, Callback on_done, CancellationFlags cancel = {});
+
+	// Like submit, the future is ready once the request is done
+	std::future<HttpResponse> fetch(HttpRequest request, CancellationFlags cancel = {});
+
+	Metrics metrics();
+
+private:
+	friend class HttpEngineUse;
+	struct Transfer;
+
+	HttpEngine() = default;
+
+	// Start the engine thread with the first user, stop it with the last
+	void retain();
+	void release();
+
+	static size_t writeCallback(void *contents, size_t size, size_t nmemb, void *userp);
+	static int cancellationCallback(void *userp, curl_off_t, curl_off_t, curl_off_t,
+					curl_off_t);
+
+	void run();
+	// Removes a finished transfer from the multi handle and calls its callback
+	void complete(std::unique_ptr<Transfer> transfer, CURLcode result);
+
+	CurlHelper curl_; // initializes curl before the multi handle is made
+
+	std::mutex lifecycle_mutex_; // serializes starting and stopping the thread
+	size_t users_ = 0;
+
+	std::mutex mutex_;
+	CURLM *multi_ = nullptr; // set while the thread runs
+	bool running_ = false;
+	std::vector<std::unique_ptr<Transfer>> queued_;
+	Metrics metrics_;
+
+	// transfers added to the multi handle, only used by the engine thread
+	std::unordered_map<CURL *, std::unique_ptr<Transfer>> active_;
+	std::thread thread_;
+};
+
+// Keeps the HTTP engine running, each filter holds one for its lifetime
+class HttpEngineUse {
+public:
+	HttpEngineUse() { HttpEngine::instance().retain(); }
+	~HttpEngineUse() { HttpEngine::instance().release(); }
+	HttpEngineUse(const HttpEngineUse &) = delete;
+	HttpEngineUse &operator=(const HttpEngineUse &) = delete;
+};
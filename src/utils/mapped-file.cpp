@@ -0,0 +1,246 @@
+#include "mapped-file.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+static std::wstring to_wide(const std::string &utf8)
+{
+	const int length = MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, nullptr, 0);
+	if (length <= 0) {
+		return std::wstring();
+	}
+	std::wstring wide((size_t)length, L'\0');
+	MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, &wide[0], length);
+	wide.resize((size_t)length - 1);
+	return wide;
+}
+
+bool MappedFile::open(const std::string &path, size_t min_size)
+{
+	close();
+	// sharing the file for reading only is the write lock: a second writer fails to open it
+	const std::wstring wide_path = to_wide(path);
+	HANDLE file = CreateFileW(wide_path.c_str(), GENERIC_READ | GENERIC_WRITE,
+				  FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL,
+				  nullptr);
+	if (file == INVALID_HANDLE_VALUE && GetLastError() == ERROR_SHARING_VIOLATION) {
+		file = CreateFileW(wide_path.c_str(), GENERIC_READ,
+				   FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+				   FILE_ATTRIBUTE_NORMAL, nullptr);
+		read_only_ = true;
+	}
+	if (file == INVALID_HANDLE_VALUE) {
+		read_only_ = false;
+		return false;
+	}
+	file_ = file;
+	size_t size = fileSize();
+	if (!read_only_ && size < min_size) {
+		size = min_size;
+	}
+	if (size == 0 || !map(size)) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+size_t MappedFile::fileSize() const
+{
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx((HANDLE)file_, &file_size)) {
+		return 0;
+	}
+	return (size_t)file_size.QuadPart;
+}
+
+bool MappedFile::map(size_t size)
+{
+	// a mapping larger than the file grows the file, the new bytes are zero
+	HANDLE mapping = CreateFileMappingW((HANDLE)file_, nullptr,
+					    read_only_ ? PAGE_READONLY : PAGE_READWRITE,
+					    (DWORD)((uint64_t)size >> 32),
+					    (DWORD)((uint64_t)size & 0xffffffff), nullptr);
+	if (!mapping) {
+		return false;
+	}
+	void *data = MapViewOfFile(mapping, read_only_ ? FILE_MAP_READ : FILE_MAP_ALL_ACCESS, 0,
+				   0, size);
+	if (!data) {
+		CloseHandle(mapping);
+		return false;
+	}
+	mapping_ = mapping;
+	data_ = (uint8_t *)data;
+	size_ = size;
+	return true;
+}
+
+void MappedFile::unmap()
+{
+	if (data_) {
+		UnmapViewOfFile(data_);
+		data_ = nullptr;
+	}
+	if (mapping_) {
+		CloseHandle((HANDLE)mapping_);
+		mapping_ = nullptr;
+	}
+	size_ = 0;
+}
+
+void MappedFile::close()
+{
+	unmap();
+	if (file_) {
+		CloseHandle((HANDLE)file_);
+		file_ = nullptr;
+	}
+	read_only_ = false;
+}
+
+void MappedFile::flush()
+{
+	if (data_ && !read_only_) {
+		FlushViewOfFile(data_, size_);
+	}
+}
+
+#else
+
+bool MappedFile::open(const std::string &path, size_t min_size)
+{
+	close();
+	fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+	if (fd_ < 0) {
+		return false;
+	}
+	// an advisory lock, held until the descriptor is closed
+	if (flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+		if (errno != EWOULDBLOCK) {
+			close();
+			return false;
+		}
+		::close(fd_);
+		fd_ = ::open(path.c_str(), O_RDONLY);
+		if (fd_ < 0) {
+			return false;
+		}
+		read_only_ = true;
+	}
+	size_t size = fileSize();
+	if (!read_only_ && size < min_size) {
+		size = min_size;
+	}
+	if (size == 0 || !map(size)) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+size_t MappedFile::fileSize() const
+{
+	struct stat st;
+	if (fstat(fd_, &st) != 0) {
+		return 0;
+	}
+	return (size_t)st.st_size;
+}
+
+bool MappedFile::map(size_t size)
+{
+	const size_t file_size = fileSize();
+	if (file_size < size && (read_only_ || ftruncate(fd_, (off_t)size) != 0)) {
+		return false;
+	}
+	void *data = mmap(nullptr, size, read_only_ ? PROT_READ : PROT_READ | PROT_WRITE,
+			  MAP_SHARED, fd_, 0);
+	if (data == MAP_FAILED) {
+		return false;
+	}
+	data_ = (uint8_t *)data;
+	size_ = size;
+	return true;
+}
+
+void MappedFile::unmap()
+{
+	if (data_) {
+		munmap(data_, size_);
+		data_ = nullptr;
+	}
+	size_ = 0;
+}
+
+void MappedFile::close()
+{
+	unmap();
+	if (fd_ >= 0) {
+		::close(fd_);
+		fd_ = -1;
+	}
+	read_only_ = false;
+}
+
+void MappedFile::flush()
+{
+	if (data_ && !read_only_) {
+		msync(data_, size_, MS_ASYNC);
+	}
+}
+
+#endif
+
+bool MappedFile::resize(size_t size)
+{
+	if (!isOpen() || read_only_) {
+		return false;
+	}
+	if (size <= size_) {
+		return true;
+	}
+	const size_t previous_size = size_;
+	unmap();
+	if (!map(size)) {
+		// keep the previous mapping usable
+		if (!map(previous_size)) {
+			close();
+		}
+		return false;
+	}
+	return true;
+}
+
+bool MappedFile::refresh()
+{
+	if (!isOpen() || !read_only_) {
+		return false;
+	}
+	const size_t size = fileSize();
+	if (size <= size_) {
+		return true;
+	}
+	const size_t previous_size = size_;
+	unmap();
+	if (!map(size)) {
+		if (!map(previous_size)) {
+			close();
+		}
+		return false;
+	}
+	return true;
+}
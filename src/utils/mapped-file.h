@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// A file mapped read-write into memory, the mapping covers the whole file. Changes are
+// written back by the OS; flush() forces them out. One process at a time writes the file,
+// the others map it read-only.
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile() { close(); }
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	// Opens or creates the file (path is UTF-8) and grows it to at least min_size bytes.
+	// New bytes read as zero. The file is locked for writing while it is open; when another
+	// process holds the lock, an existing file is mapped read-only at its current size.
+	bool open(const std::string &path, size_t min_size);
+	void close();
+
+	// Grows the file and remaps it. Pointers into the previous mapping become invalid.
+	// Fails for a read-only file.
+	bool resize(size_t size);
+	// Remaps a read-only file grown by the process writing it. Pointers into the previous
+	// mapping become invalid when it is remapped.
+	bool refresh();
+	void flush();
+
+	bool isOpen() const { return data_ != nullptr; }
+	bool isReadOnly() const { return read_only_; }
+	uint8_t *data() const { return data_; }
+	size_t size() const { return size_; }
+
+private:
+	// Current size of the open file, 0 if it cannot be read
+	size_t fileSize() const;
+	bool map(size_t size);
+	void unmap();
+
+#ifdef _WIN32
+	void *file_ = nullptr;    // HANDLE
+	void *mapping_ = nullptr; // HANDLE
+#else
+	int fd_ = -1;
+#endif
+	uint8_t *data_ = nullptr;
+	size_t size_ = 0;
+	bool read_only_ = false;
+};
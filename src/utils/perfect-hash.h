@@ -0,0 +1,166 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+namespace perfect_hash {
+
+struct StringPair {
+	std::string_view first;
+	std::string_view second;
+};
+
+// FNV-1a over the key with the seed folded into the offset basis, finished with the
+// murmur3 mixer so different seeds give unrelated slot assignments.
+constexpr uint32_t hash(std::string_view key, uint32_t seed)
+{
+	uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+	for (char c : key) {
+		h ^= (uint8_t)c;
+		h *= 16777619u;
+	}
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35u;
+	h ^= h >> 16;
+	return h;
+}
+
+// Immutable string -> string table with a collision-free hash built at compile time using
+// hash-and-displace: keys are grouped into buckets by one hash, and each bucket gets a seed
+// that places all of its keys into free slots. A lookup is two hashes and one comparison.
+template<size_t N> class StaticStringMap {
+public:
+	static constexpr size_t bucket_count = N / 2 + 1;
+	static constexpr size_t slot_count = 2 * N;
+
+	constexpr explicit StaticStringMap(const std::array<StringPair, N> &entries)
+		: entries_(entries),
+		  seeds_{},
+		  slots_{}
+	{
+		build();
+	}
+
+	// Returns the value for key, or fallback when the key is not in the table
+	constexpr std::string_view find(std::string_view key,
+					std::string_view fallback = std::string_view()) const
+	{
+		const uint32_t seed = seeds_[hash(key, 0) % bucket_count];
+		const uint16_t index = slots_[hash(key, seed) % slot_count];
+		if (index != EMPTY_SLOT && entries_[index].first == key) {
+			return entries_[index].second;
+		}
+		return fallback;
+	}
+
+	constexpr bool contains(std::string_view key) const
+	{
+		const uint32_t seed = seeds_[hash(key, 0) % bucket_count];
+		const uint16_t index = slots_[hash(key, seed) % slot_count];
+		return index != EMPTY_SLOT && entries_[index].first == key;
+	}
+
+	constexpr const std::array<StringPair, N> &entries() const { return entries_; }
+
+private:
+	static constexpr uint16_t EMPTY_SLOT = 0xffff;
+	static constexpr uint32_t MAX_SEED = 1 << 16;
+
+	constexpr void build()
+	{
+		for (size_t s = 0; s < slot_count; s++) {
+			slots_[s] = EMPTY_SLOT;
+		}
+
+		// group the keys by bucket (counting sort)
+		std::array<size_t, bucket_count + 1> bucket_start{};
+		for (size_t i = 0; i < N; i++) {
+			bucket_start[hash(entries_[i].first, 0) % bucket_count + 1]++;
+		}
+		for (size_t b = 0; b < bucket_count; b++) {
+			bucket_start[b + 1] += bucket_start[b];
+		}
+		std::array<size_t, N> members{};
+		std::array<size_t, bucket_count> filled{};
+		for (size_t i = 0; i < N; i++) {
+			const size_t b = hash(entries_[i].first, 0) % bucket_count;
+			members[bucket_start[b] + filled[b]++] = i;
+		}
+
+		// place the largest buckets first, while most slots are still free
+		std::array<size_t, bucket_count> order{};
+		for (size_t b = 0; b < bucket_count; b++) {
+			order[b] = b;
+		}
+		for (size_t i = 1; i < bucket_count; i++) {
+			const size_t b = order[i];
+			size_t j = i;
+			for (; j > 0 && filled[order[j - 1]] < filled[b]; j--) {
+				order[j] = order[j - 1];
+			}
+			order[j] = b;
+		}
+
+		for (size_t o = 0; o < bucket_count; o++) {
+			const size_t b = order[o];
+			if (filled[b] == 0) {
+				break;
+			}
+			const size_t first = bucket_start[b];
+			const size_t last = bucket_start[b + 1];
+			for (size_t i = first; i < last; i++) {
+				const std::string_view key = entries_[members[i]].first;
+				for (size_t j = i + 1; j < last; j++) {
+					if (key == entries_[members[j]].first) {
+						throw std::logic_error("duplicate key");
+					}
+				}
+			}
+			uint32_t seed = 1;
+			for (; seed < MAX_SEED; seed++) {
+				std::array<size_t, N> placed{};
+				bool fits = true;
+				for (size_t i = first; i < last && fits; i++) {
+					const std::string_view key = entries_[members[i]].first;
+					const size_t s = hash(key, seed) % slot_count;
+					fits = slots_[s] == EMPTY_SLOT;
+					for (size_t k = first; k < i && fits; k++) {
+						fits = placed[k - first] != s;
+					}
+					placed[i - first] = s;
+				}
+				if (fits) {
+					for (size_t i = first; i < last; i++) {
+						slots_[placed[i - first]] = (uint16_t)members[i];
+					}
+					break;
+				}
+			}
+			if (seed == MAX_SEED) {
+				throw std::logic_error("no perfect hash seed found");
+			}
+			seeds_[b] = seed;
+		}
+	}
+
+	std::array<StringPair, N> entries_;
+	std::array<uint32_t, bucket_count> seeds_;
+	std::array<uint16_t, slot_count> slots_;
+};
+
+template<size_t N>
+constexpr StaticStringMap<N> make_static_string_map(const StringPair (&entries)[N])
+{
+	std::array<StringPair, N> table{};
+	for (size_t i = 0; i < N; i++) {
+		table[i] = entries[i];
+	}
+	return StaticStringMap<N>(table);
+}
+
+} // namespace perfect_hash
@@ -0,0 +1,163 @@
+#include "rate-limiter.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+#include <obs-module.h>
+#include "plugin-support.h"
+
+#include "cancellation.h"
+
+// Keys start with the service, the rest of the key is not needed in the log
+static std::string service_of(const std::string &key)
+{
+	return key.substr(0, key.find('|'));
+}
+
+RateLimiter &RateLimiter::instance()
+{
+	static RateLimiter limiter;
+	return limiter;
+}
+
+std::string RateLimiter::makeKey(const std::string &service, const std::string &credential)
+{
+	return service + '|' + std::to_string(std::hash<std::string>()(credential));
+}
+
+void RateLimiter::refill(Bucket &bucket)
+{
+	const auto now = std::chrono::steady_clock::now();
+	const double elapsed = std::chrono::duration<double>(now - bucket.refilled).count();
+	bucket.tokens = std::min(bucket.rate, bucket.tokens + elapsed * bucket.rate);
+	bucket.refilled = now;
+}
+
+void RateLimiter::updateRate(const std::string &key)
+{
+	auto it = buckets_.find(key);
+	if (it == buckets_.end()) {
+		return;
+	}
+	Bucket &bucket = it->second;
+	if (bucket.requested.empty()) {
+		buckets_.erase(it);
+		return;
+	}
+	double rate = bucket.requested.begin()->second;
+	for (const auto &entry : bucket.requested) {
+		rate = std::min(rate, entry.second);
+	}
+	if (bucket.rate == 0) {
+		// a new bucket starts full
+		bucket.tokens = rate;
+		bucket.refilled = std::chrono::steady_clock::now();
+	} else {
+		refill(bucket);
+	}
+	bucket.rate = rate;
+	bucket.tokens = std::min(bucket.tokens, rate);
+}
+
+void RateLimiter::setRate(const void *owner, const std::vector<std::string> &keys,
+			  double per_second)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	std::vector<std::string> changed;
+	for (auto &entry : buckets_) {
+		if (entry.second.requested.erase(owner) > 0) {
+			changed.push_back(entry.first);
+		}
+	}
+	if (per_second > 0) {
+		for (const std::string &key : keys) {
+			buckets_[key].requested[owner] = per_second;
+			changed.push_back(key);
+		}
+	}
+	for (const std::string &key : changed) {
+		updateRate(key);
+	}
+}
+
+void RateLimiter::removeOwner(const void *owner)
+{
+	setRate(owner, {}, 0);
+}
+
+bool RateLimiter::acquire(const std::string &key, RequestPriority priority)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	auto it = buckets_.find(key);
+	if (it == buckets_.end()) {
+		metrics_.granted++;
+		return true;
+	}
+	refill(it->second);
+
+	if (priority == REQUEST_PRIORITY_PARTIAL) {
+		Bucket &bucket = it->second;
+		// keep the lower half of the bucket, and at least one token, for finals
+		const double reserve = std::max(1.0, bucket.rate / 2);
+		if (bucket.waiting_finals > 0 || bucket.tokens < reserve + 1) {
+			metrics_.shed_partials++;
+			obs_log(LOG_DEBUG, "rate limit reached, not sending a partial (%s)",
+				service_of(key).c_str());
+			return false;
+		}
+		bucket.tokens -= 1;
+		metrics_.granted++;
+		return true;
+	}
+
+	const auto deadline = std::chrono::steady_clock::now() + MAX_WAIT;
+	bool delayed = false;
+	it->second.waiting_finals++;
+	for (;;) {
+		// the bucket may have been removed by setRate while waiting
+		it = buckets_.find(key);
+		if (it == buckets_.end()) {
+			metrics_.granted++;
+			return true;
+		}
+		Bucket &bucket = it->second;
+		refill(bucket);
+		const auto now = std::chrono::steady_clock::now();
+		const bool granted = bucket.tokens >= 1;
+		const bool cancelled = !granted && CancellationScope::cancelled();
+		const bool expired = !granted && now >= deadline;
+		if (granted || cancelled || expired) {
+			bucket.waiting_finals -= std::min<uint32_t>(bucket.waiting_finals, 1);
+		}
+		if (granted) {
+			bucket.tokens -= 1;
+			metrics_.granted++;
+			if (delayed) {
+				metrics_.delayed++;
+			}
+			return true;
+		}
+		if (expired) {
+			obs_log(LOG_WARNING, "rate limit reached, not sending a request (%s)",
+				service_of(key).c_str());
+		}
+		if (cancelled || expired) {
+			metrics_.dropped_finals++;
+			return false;
+		}
+		delayed = true;
+		// wait for the next token, waking up now and then to check for cancellation
+		const std::chrono::duration<double> wait((1 - bucket.tokens) / bucket.rate);
+		lock.unlock();
+		std::this_thread::sleep_for(std::min<std::chrono::duration<double>>(
+			wait, std::chrono::milliseconds(20)));
+		lock.lock();
+	}
+}
+
+RateLimiter::Metrics RateLimiter::metrics()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return metrics_;
+}
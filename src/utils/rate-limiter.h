@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// How much a request matters when the endpoint's rate limit is reached
+enum RequestPriority {
+	REQUEST_PRIORITY_PARTIAL = 0, // outdated by the next partial, shed first
+	REQUEST_PRIORITY_FINAL = 1,   // waits for its turn
+};
+
+// Token buckets pacing the requests to each (service, credential) pair, shared by all
+// filters. A bucket holds one second's worth of requests. Partials only spend the upper half
+// of it, the lower half is kept for finals, and are shed when that is empty or a final is
+// waiting; below 2 requests per second only finals are sent. Finals wait for a token, up to
+// MAX_WAIT.
+class RateLimiter {
+public:
+	struct Metrics {
+		uint64_t granted = 0;        // requests let through
+		uint64_t delayed = 0;        // finals that had to wait for a token
+		uint64_t shed_partials = 0;  // partials not sent
+		uint64_t dropped_finals = 0; // finals that waited MAX_WAIT, or were cancelled
+	};
+
+	static constexpr std::chrono::milliseconds MAX_WAIT{5000};
+
+	static RateLimiter &instance();
+
+	// Identifies a bucket without keeping the credential itself
+	static std::string makeKey(const std::string &service, const std::string &credential);
+
+	// Sets the rate owner asks for on the buckets of keys, in requests per second, 0 for no
+	// limit. Filters using the same credential share its bucket, which goes at the lowest
+	// rate any of its owners asks for. The rates owner set on other buckets are withdrawn.
+	void setRate(const void *owner, const std::vector<std::string> &keys, double per_second);
+	// Withdraws every rate owner set, when its filter goes away
+	void removeOwner(const void *owner);
+
+	// Takes a token for a request, false if the request must not be sent. A final waiting
+	// for a token gives up when the calling thread's CancellationScope is cancelled.
+	bool acquire(const std::string &key, RequestPriority priority);
+
+	Metrics metrics();
+
+private:
+	struct Bucket {
+		double rate = 0;
+		double tokens = 0;
+		uint32_t waiting_finals = 0;
+		std::chrono::steady_clock::time_point refilled;
+		std::unordered_map<const void *, double> requested; // rate asked for by each owner
+	};
+
+	// Adds the tokens earned since the last refill, up to one second's worth
+	static void refill(Bucket &bucket);
+	// Applies the lowest requested rate, erasing the bucket once nobody limits it
+	void updateRate(const std::string &key);
+
+	std::mutex mutex_;
+	std::unordered_map<std::string, Bucket> buckets_;
+	Metrics metrics_;
+};
@@ -0,0 +1,114 @@
+#include "source-cache.h"
+
+SourceCache::SourceCache()
+{
+	signal_handler_t *sh = obs_get_signal_handler();
+	signal_handler_connect(sh, "source_create", sourceCreated, this);
+	signal_handler_connect(sh, "source_rename", sourceRenamed, this);
+	signal_handler_connect(sh, "source_remove", sourceRemoved, this);
+}
+
+SourceCache::~SourceCache()
+{
+	// a signal being handled holds the handler's lock, none runs once these return
+	signal_handler_t *sh = obs_get_signal_handler();
+	signal_handler_disconnect(sh, "source_create", sourceCreated, this);
+	signal_handler_disconnect(sh, "source_rename", sourceRenamed, this);
+	signal_handler_disconnect(sh, "source_remove", sourceRemoved, this);
+	clear();
+}
+
+obs_source_t *SourceCache::get(const std::string &name)
+{
+	obs_weak_source_t *stale = nullptr;
+	uint64_t generation;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = sources_.find(name);
+		if (it != sources_.end()) {
+			if (it->second == nullptr) {
+				return nullptr;
+			}
+			obs_source_t *source = obs_weak_source_get_source(it->second);
+			if (source != nullptr && !obs_source_removed(source)) {
+				return source;
+			}
+			// destroyed, or removed before its signal reached us
+			obs_source_release(source);
+			stale = it->second;
+			sources_.erase(it);
+		}
+		generation = generation_;
+	}
+	obs_weak_source_release(stale);
+
+	// looked up outside the lock, OBS may signal while holding its source list lock
+	obs_source_t *source = obs_get_source_by_name(name.c_str());
+	if (source != nullptr && obs_source_removed(source)) {
+		obs_source_release(source);
+		source = nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (generation == generation_ && sources_.find(name) == sources_.end()) {
+		sources_[name] = source != nullptr ? obs_source_get_weak_source(source) : nullptr;
+	}
+	return source;
+}
+
+void SourceCache::clear()
+{
+	std::unordered_map<std::string, obs_weak_source_t *> sources;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		generation_++;
+		sources.swap(sources_);
+	}
+	for (const auto &entry : sources) {
+		obs_weak_source_release(entry.second);
+	}
+}
+
+void SourceCache::invalidate(const char *name)
+{
+	if (name == nullptr) {
+		return;
+	}
+	obs_weak_source_t *weak = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		generation_++;
+		auto it = sources_.find(name);
+		if (it == sources_.end()) {
+			return;
+		}
+		weak = it->second;
+		sources_.erase(it);
+	}
+	obs_weak_source_release(weak);
+}
+
+void SourceCache::sourceCreated(void *data, calldata_t *cd)
+{
+	// a name remembered as missing may belong to the new source
+	obs_source_t *source = (obs_source_t *)calldata_ptr(cd, "source");
+	if (source != nullptr) {
+		static_cast<SourceCache *>(data)->invalidate(obs_source_get_name(source));
+	}
+}
+
+void SourceCache::sourceRenamed(void *data, calldata_t *cd)
+{
+	SourceCache *cache = static_cast<SourceCache *>(data);
+	// captions follow the name, not the source, as the lookup by name always did
+	cache->invalidate(calldata_string(cd, "prev_name"));
+	cache->invalidate(calldata_string(cd, "new_name"));
+}
+
+void SourceCache::sourceRemoved(void *data, calldata_t *cd)
+{
+	obs_source_t *source = (obs_source_t *)calldata_ptr(cd, "source");
+	if (source != nullptr) {
+		static_cast<SourceCache *>(data)->invalidate(obs_source_get_name(source));
+	}
+}
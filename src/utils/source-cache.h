@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <obs.h>
+
+// Sources looked up by name, kept as weak references. obs_get_source_by_name takes the lock
+// of OBS's global source list, which every filter would otherwise do for each caption it
+// shows. A name is resolved once, and dropped again when a source with that name is created,
+// renamed or removed. A name with no source is remembered too, until one appears.
+class SourceCache {
+public:
+	SourceCache();
+	~SourceCache();
+
+	SourceCache(const SourceCache &) = delete;
+	SourceCache &operator=(const SourceCache &) = delete;
+
+	// A new reference to the source called name, nullptr if there is none. The caller
+	// releases it with obs_source_release.
+	obs_source_t *get(const std::string &name);
+
+	void clear();
+
+private:
+	static void sourceCreated(void *data, calldata_t *cd);
+	static void sourceRenamed(void *data, calldata_t *cd);
+	static void sourceRemoved(void *data, calldata_t *cd);
+
+	void invalidate(const char *name);
+
+	std::mutex mutex_;
+	// nullptr for a name that had no source
+	std::unordered_map<std::string, obs_weak_source_t *> sources_;
+	// bumped on every invalidation, a lookup that raced one is not stored
+	uint64_t generation_ = 0;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+// Splits a text/event-stream body into events as it arrives. Chunks may end anywhere, an
+// event is passed on once the blank line that ends it has been received.
+class SseParser {
+public:
+	typedef std::function<void(const std::string &event, const std::string &data)>
+		EventCallback;
+
+	explicit SseParser(EventCallback on_event) : on_event_(std::move(on_event)) {}
+
+	void feed(const char *data, size_t size)
+	{
+		buffer_.append(data, size);
+		size_t start = 0;
+		size_t end;
+		while ((end = buffer_.find('\n', start)) != std::string::npos) {
+			size_t line_end = end;
+			if (line_end > start && buffer_[line_end - 1] == '\r') {
+				line_end--;
+			}
+			handleLine(buffer_.substr(start, line_end - start));
+			start = end + 1;
+		}
+		buffer_.erase(0, start);
+	}
+
+private:
+	void handleLine(const std::string &line)
+	{
+		if (line.empty()) {
+			if (has_data_) {
+				on_event_(event_, data_);
+			}
+			event_.clear();
+			data_.clear();
+			has_data_ = false;
+			return;
+		}
+		if (line[0] == ':') {
+			// comment, e.g. a keepalive
+			return;
+		}
+		const size_t colon = line.find(':');
+		const std::string field = line.substr(0, colon);
+		std::string value = colon == std::string::npos ? "" : line.substr(colon + 1);
+		if (!value.empty() && value[0] == ' ') {
+			value.erase(0, 1);
+		}
+		if (field == "event") {
+			event_ = value;
+		} else if (field == "data") {
+			if (has_data_) {
+				data_ += '\n';
+			}
+			data_ += value;
+			has_data_ = true;
+		}
+	}
+
+	EventCallback on_event_;
+	std::string buffer_;
+	std::string event_;
+	std::string data_;
+	bool has_data_ = false;
+};
@@ -0,0 +1,155 @@
+#include "word-filter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <deque>
+
+#include <nlohmann/json.hpp>
+
+#include <obs-module.h>
+#include "plugin-support.h"
+
+std::map<std::string, std::string> deserialize_filter_words_replace(const std::string &data)
+{
+	std::map<std::string, std::string> replacements;
+	try {
+		for (const nlohmann::json &entry : nlohmann::json::parse(data)) {
+			replacements[entry.at("key").get<std::string>()] =
+				entry.value("value", std::string());
+		}
+	} catch (const nlohmann::json::exception &e) {
+		obs_log(LOG_WARNING, "Failed to read the filter words: %s", e.what());
+		replacements.clear();
+	}
+	return replacements;
+}
+
+static unsigned char fold(char c)
+{
+	return (unsigned char)std::tolower((unsigned char)c);
+}
+
+static bool is_regex(const std::string &pattern)
+{
+	return pattern.find_first_of("\\^$.|?*+()[]{}") != std::string::npos;
+}
+
+WordFilter::WordFilter(const std::map<std::string, std::string> &replacements)
+{
+	for (const auto &entry : replacements) {
+		if (entry.first.empty()) {
+			continue;
+		}
+		if (is_regex(entry.first)) {
+			try {
+				regexes_.emplace_back(std::regex(entry.first, std::regex::icase),
+						      entry.second);
+				continue;
+			} catch (const std::regex_error &e) {
+				obs_log(LOG_WARNING,
+					"Filter '%s' is not a valid pattern, matched as a word: %s",
+					entry.first.c_str(), e.what());
+			}
+		}
+		std::string folded;
+		for (char c : entry.first) {
+			folded += (char)fold(c);
+		}
+		patterns_.emplace_back(folded, entry.second);
+	}
+
+	// the trie of the words
+	nodes_.emplace_back();
+	for (size_t p = 0; p < patterns_.size(); p++) {
+		int32_t node = 0;
+		for (char c : patterns_[p].first) {
+			int32_t next = child(node, (unsigned char)c);
+			if (next < 0) {
+				next = (int32_t)nodes_.size();
+				auto &edges = nodes_[node].next;
+				edges.insert(std::lower_bound(edges.begin(), edges.end(),
+							      std::make_pair((unsigned char)c, 0)),
+					     {(unsigned char)c, next});
+				nodes_.emplace_back();
+			}
+			node = next;
+		}
+		nodes_[node].pattern = (int32_t)p;
+	}
+
+	// fail and output links, breadth first so shorter suffixes are done first
+	std::deque<int32_t> queue;
+	for (const auto &edge : nodes_[0].next) {
+		queue.push_back(edge.second);
+	}
+	while (!queue.empty()) {
+		const int32_t node = queue.front();
+		queue.pop_front();
+		Node &current = nodes_[node];
+		current.output = current.pattern >= 0 ? node : nodes_[current.fail].output;
+		for (const auto &edge : current.next) {
+			nodes_[edge.second].fail =
+				node == 0 ? 0 : step(nodes_[node].fail, edge.first);
+			queue.push_back(edge.second);
+		}
+	}
+}
+
+int32_t WordFilter::child(int32_t node, unsigned char c) const
+{
+	const auto &edges = nodes_[node].next;
+	auto it = std::lower_bound(edges.begin(), edges.end(), std::make_pair(c, 0));
+	return it != edges.end() && it->first == c ? it->second : -1;
+}
+
+int32_t WordFilter::step(int32_t node, unsigned char c) const
+{
+	for (;;) {
+		const int32_t next = child(node, c);
+		if (next >= 0) {
+			return next;
+		}
+		if (node == 0) {
+			return 0;
+		}
+		node = nodes_[node].fail;
+	}
+}
+
+std::string WordFilter::apply(const std::string &text) const
+{
+	std::string result;
+	if (patterns_.empty()) {
+		result = text;
+	} else {
+		// the longest word starting at each position, -1 for none
+		std::vector<int32_t> match(text.size(), -1);
+		int32_t node = 0;
+		for (size_t i = 0; i < text.size(); i++) {
+			node = step(node, fold(text[i]));
+			for (int32_t out = nodes_[node].output; out >= 0;
+			     out = nodes_[nodes_[out].fail].output) {
+				const int32_t p = nodes_[out].pattern;
+				const size_t length = patterns_[p].first.size();
+				const size_t start = i + 1 - length;
+				const int32_t previous = match[start];
+				if (previous < 0 || patterns_[previous].first.size() < length) {
+					match[start] = p;
+				}
+			}
+		}
+		result.reserve(text.size());
+		for (size_t i = 0; i < text.size();) {
+			if (match[i] >= 0) {
+				result += patterns_[match[i]].second;
+				i += patterns_[match[i]].first.size();
+			} else {
+				result += text[i++];
+			}
+		}
+	}
+	for (const auto &regex : regexes_) {
+		result = std::regex_replace(result, regex.first, regex.second);
+	}
+	return result;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Parses the filter_words_replace setting, a JSON array of {"key": ..., "value": ...}
+// objects, into replacements by pattern. Returns an empty map if the setting is malformed.
+std::map<std::string, std::string> deserialize_filter_words_replace(const std::string &data);
+
+// Replaces the entries of a filter list in captions, ignoring case. Plain words are all
+// found in one pass over the text with an Aho-Corasick automaton built once per list; at each
+// position the longest word starting there wins. Entries containing regular expression syntax
+// are compiled once and applied after that pass, one after the other.
+class WordFilter {
+public:
+	explicit WordFilter(const std::map<std::string, std::string> &replacements);
+
+	bool empty() const { return patterns_.empty() && regexes_.empty(); }
+
+	std::string apply(const std::string &text) const;
+
+private:
+	struct Node {
+		std::vector<std::pair<unsigned char, int32_t>> next; // sorted by byte
+		int32_t fail = 0;
+		int32_t output = -1;  // nearest node ending a word, this one or along fail links
+		int32_t pattern = -1; // the word ending at this node
+	};
+
+	int32_t child(int32_t node, unsigned char c) const;
+	// The state after reading c in node, following fail links
+	int32_t step(int32_t node, unsigned char c) const;
+
+	std::vector<Node> nodes_;
+	// plain words, case folded, and their replacements
+	std::vector<std::pair<std::string, std::string>> patterns_;
+	std::vector<std::pair<std::regex, std::string>> regexes_;
+};